@@ -4,6 +4,14 @@
 #include <iostream>
 #include <stdexcept>
 
+// the resizes of every list made by the calling thread, so a search
+// running on its own thread counts only its own
+inline long& arrayListResizes()
+{
+    thread_local long resizes = 0;
+    return resizes;
+}
+
 template <typename T>
 class ArrayList
 {
@@ -14,6 +22,7 @@ private:
    
     void resizeUp()
     {
+        arrayListResizes() += 1;
         length *= 2;
         T* temp = items;
 
@@ -34,6 +43,7 @@ private:
 
     void resizeDown()
     {
+        arrayListResizes() += 1;
         length *= 0.5;
         T* temp = items;
         items = new T[length];
@@ -0,0 +1,246 @@
+#ifndef BIT_PLANE_H
+#define BIT_PLANE_H
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#define BIT_PLANE_TAG "BPL1"
+#define BIT_PLANE_HEADER 16
+#define TILE_BITS 3
+#define TILE_SIZE (1 << TILE_BITS)
+
+// one bit for every cell of a width * height grid, the bits are kept in
+// tiles of 8 by 8 cells so every tile is a single word and the neighbors
+// of a cell are almost always in the same word
+//
+// the file is a "BPL1" tag, the width, the height, the tile size and the
+// words, all little-endian, the words are mapped from the file as they are
+// so opening a plane of any size costs the same, the mapping is private
+// so changing a bit never writes to the file
+class BitPlane
+{
+private:
+    uint64_t* words;
+    int width;
+    int height;
+    int tilesWide;
+
+    // the mapped file, or the allocated words when there is no mapping
+    char* mapping;
+    size_t mappingSize;
+    bool mapped;
+
+    static long wordsNumberOf(int w, int h)
+    {
+        return (long)((w + TILE_SIZE - 1) >> TILE_BITS) * ((h + TILE_SIZE - 1) >> TILE_BITS);
+    }
+
+    long wordOf(int x, int y)
+    {
+        return (long)(y >> TILE_BITS) * tilesWide + (x >> TILE_BITS);
+    }
+
+    static uint64_t bitOf(int x, int y)
+    {
+        return 1ULL << (((y & (TILE_SIZE - 1)) << TILE_BITS) | (x & (TILE_SIZE - 1)));
+    }
+
+    void setSize(int w, int h)
+    {
+        width = w;
+        height = h;
+        tilesWide = (w + TILE_SIZE - 1) >> TILE_BITS;
+    }
+
+public:
+    BitPlane()
+    {
+        words = nullptr;
+        width = 0;
+        height = 0;
+        tilesWide = 0;
+        mapping = nullptr;
+        mappingSize = 0;
+        mapped = false;
+    }
+    ~BitPlane()
+    {
+        release();
+    }
+
+    BitPlane(const BitPlane&) = delete;
+    BitPlane& operator=(const BitPlane&) = delete;
+
+    // a plane of w * h cleared bits
+    void create(int w, int h)
+    {
+        release();
+        long wordsNumber = wordsNumberOf(w, h);
+        mapping = new char[BIT_PLANE_HEADER + wordsNumber * sizeof(uint64_t)];
+        mappingSize = BIT_PLANE_HEADER + wordsNumber * sizeof(uint64_t);
+        words = (uint64_t*)(mapping + BIT_PLANE_HEADER);
+        for (long i = 0; i < wordsNumber; i += 1) words[i] = 0;
+        setSize(w, h);
+    }
+
+    // maps a saved plane, returns false if the file isn't one
+    bool map(const char* path)
+    {
+        release();
+    #if defined(_WIN32)
+        // no mmap here, the words are read instead
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        size_t size = file.tellg();
+        if (size < BIT_PLANE_HEADER) return false;
+
+        char* data = new char[size];
+        file.seekg(0);
+        file.read(data, size);
+        if (!file)
+        {
+            delete [] data;
+            return false;
+        }
+    #else
+        int descriptor = open(path, O_RDONLY);
+        if (descriptor == -1) return false;
+
+        struct stat status;
+        if (fstat(descriptor, &status) == -1 || status.st_size < BIT_PLANE_HEADER)
+        {
+            close(descriptor);
+            return false;
+        }
+        size_t size = status.st_size;
+
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (data == MAP_FAILED) return false;
+    #endif
+
+        mapping = (char*)data;
+        mappingSize = size;
+        mapped = true;
+
+        int header[3];
+        memcpy(header, mapping + 4, sizeof(header));
+        if (memcmp(mapping, BIT_PLANE_TAG, 4) != 0 || header[0] <= 0 || header[1] <= 0 || header[2] != TILE_SIZE ||
+            size < BIT_PLANE_HEADER + wordsNumberOf(header[0], header[1]) * sizeof(uint64_t))
+        {
+            release();
+            return false;
+        }
+
+        words = (uint64_t*)(mapping + BIT_PLANE_HEADER);
+        setSize(header[0], header[1]);
+        return true;
+    }
+
+    // the file is written beside the path and moved over it at the end,
+    // so a plane mapped from the same path keeps reading the old file
+    bool save(const char* path)
+    {
+        if (!isLoaded()) return false;
+
+        std::string temporary = std::string(path) + ".tmp";
+        {
+            std::ofstream file(temporary.c_str(), std::ios::binary);
+            if (!file) return false;
+
+            int header[3] = {width, height, TILE_SIZE};
+            file.write(BIT_PLANE_TAG, 4);
+            file.write((const char*)header, sizeof(header));
+            file.write((const char*)words, wordsNumberOf(width, height) * sizeof(uint64_t));
+            if (!file) return false;
+        }
+        return rename(temporary.c_str(), path) == 0;
+    }
+
+    void release()
+    {
+        if (mapping != nullptr)
+        {
+        #if defined(_WIN32)
+            delete [] mapping;
+        #else
+            if (mapped) munmap(mapping, mappingSize);
+            else delete [] mapping;
+        #endif
+        }
+        words = nullptr;
+        mapping = nullptr;
+        mappingSize = 0;
+        mapped = false;
+        setSize(0, 0);
+    }
+
+    void swap(BitPlane& other)
+    {
+        std::swap(words, other.words);
+        std::swap(width, other.width);
+        std::swap(height, other.height);
+        std::swap(tilesWide, other.tilesWide);
+        std::swap(mapping, other.mapping);
+        std::swap(mappingSize, other.mappingSize);
+        std::swap(mapped, other.mapped);
+    }
+
+    bool isLoaded() {return words != nullptr;}
+
+    bool isInside(int x, int y)
+    {
+        return x >= 0 && y >= 0 && x < width && y < height;
+    }
+
+    // cells outside of the plane are cleared
+    bool get(int x, int y)
+    {
+        return isInside(x, y) && (words[wordOf(x, y)] & bitOf(x, y)) != 0;
+    }
+
+    void set(int x, int y, bool bit)
+    {
+        if (!isInside(x, y))
+        {
+            throw std::runtime_error("The cell is outside of the plane");
+        }
+        if (bit) words[wordOf(x, y)] |= bitOf(x, y);
+        else words[wordOf(x, y)] &= ~bitOf(x, y);
+    }
+
+    // the set bits of the tile holding x, y
+    int countTile(int x, int y)
+    {
+        if (!isInside(x, y)) return 0;
+        return __builtin_popcountll(words[wordOf(x, y)]);
+    }
+
+    // copies the bits of another plane of the same size
+    void copy(BitPlane& other)
+    {
+        if (other.width != width || other.height != height)
+        {
+            throw std::runtime_error("The planes have different sizes");
+        }
+        memcpy(words, other.words, wordsNumberOf(width, height) * sizeof(uint64_t));
+    }
+
+    int getWidth() {return width;}
+    int getHeight() {return height;}
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef BLOCK_COUNTS_H
+#define BLOCK_COUNTS_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "./chunkdirectory.hpp"
+
+#define BLOCK_BITS 3
+#define BLOCK_SIZE (1 << BLOCK_BITS)
+#define BLOCK_TYPES 8
+#define CHUNK_BLOCKS ((CHUNK_SIZE / BLOCK_SIZE) * (CHUNK_SIZE / BLOCK_SIZE))
+
+// how many cells of every type a block of BLOCK_SIZE squared cells has,
+// so a zoomed out view draws a block without looking at its cells
+// only types below BLOCK_TYPES are counted
+//
+// types marked as transient are counted per generation like in the grids,
+// a new generation takes them out of every block at once
+// K needs x and y members
+template <typename K>
+class BlockCounts
+{
+private:
+    struct Chunk
+    {
+        // the first cell of the chunk
+        int x;
+        int y;
+
+        unsigned char counts[CHUNK_BLOCKS][BLOCK_TYPES];
+        // the generation the transient counts of a block belong to
+        unsigned int generations[CHUNK_BLOCKS];
+
+        Chunk()
+        {
+            for (int b = 0; b < CHUNK_BLOCKS; b += 1)
+            {
+                for (int t = 0; t < BLOCK_TYPES; t += 1) counts[b][t] = 0;
+                generations[b] = 0;
+            }
+        }
+    };
+
+    typedef ChunkDirectory<Chunk> Directory;
+
+    Directory chunks;
+    unsigned int generation;
+    unsigned int transientTypes;
+
+    static int blockOf(int x, int y)
+    {
+        int index = Directory::indexOf(x, y);
+        int column = (index % CHUNK_SIZE) >> BLOCK_BITS;
+        int row = (index / CHUNK_SIZE) >> BLOCK_BITS;
+        return row * (CHUNK_SIZE / BLOCK_SIZE) + column;
+    }
+
+    bool isTransient(int type)
+    {
+        return (transientTypes >> type) & 1;
+    }
+
+    // drops the transient counts of an older generation
+    void refresh(Chunk* chunk, int block)
+    {
+        if (chunk->generations[block] == generation) return;
+
+        for (int t = 0; t < BLOCK_TYPES; t += 1)
+        {
+            if (isTransient(t)) chunk->counts[block][t] = 0;
+        }
+        chunk->generations[block] = generation;
+    }
+
+public:
+    BlockCounts()
+    {
+        generation = 1;
+        transientTypes = 0;
+    }
+
+    BlockCounts(const BlockCounts&) = delete;
+    BlockCounts& operator=(const BlockCounts&) = delete;
+
+    void markTransient(int type)
+    {
+        transientTypes |= 1u << type;
+    }
+
+    // a cell of the type was put at k
+    void add(K k, int type)
+    {
+        if (type < 0 || type >= BLOCK_TYPES) return;
+
+        Chunk* chunk = chunks.findOrCreate(k.x, k.y);
+        int block = blockOf(k.x, k.y);
+        refresh(chunk, block);
+        chunk->counts[block][type] += 1;
+    }
+
+    // a cell of the type was taken from k
+    void remove(K k, int type)
+    {
+        if (type < 0 || type >= BLOCK_TYPES) return;
+
+        Chunk* chunk = chunks.find(k.x, k.y);
+        if (chunk == nullptr) return;
+        int block = blockOf(k.x, k.y);
+        refresh(chunk, block);
+        if (chunk->counts[block][type] > 0) chunk->counts[block][type] -= 1;
+    }
+
+    // the cells of the type in the block holding x, y
+    int countAt(int x, int y, int type)
+    {
+        Chunk* chunk = chunks.find(x, y);
+        if (chunk == nullptr) return 0;
+
+        int block = blockOf(x, y);
+        if (isTransient(type) && chunk->generations[block] != generation) return 0;
+        return chunk->counts[block][type];
+    }
+
+    void clearTransient()
+    {
+        generation += 1;
+        if (generation == 0)
+        {
+            for (int c = 0; c < chunks.getSize(); c += 1)
+            {
+                Chunk* chunk = chunks.get(c);
+                for (int b = 0; b < CHUNK_BLOCKS; b += 1) refresh(chunk, b);
+            }
+            generation = 1;
+        }
+    }
+
+    // the chunks stay allocated
+    void clear()
+    {
+        for (int c = 0; c < chunks.getSize(); c += 1)
+        {
+            Chunk* chunk = chunks.get(c);
+            for (int b = 0; b < CHUNK_BLOCKS; b += 1)
+            {
+                for (int t = 0; t < BLOCK_TYPES; t += 1) chunk->counts[b][t] = 0;
+            }
+        }
+    }
+
+    int getChunksNumber() {return chunks.getSize();}
+};
+
+#endif
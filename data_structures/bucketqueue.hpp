@@ -0,0 +1,180 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "./arraylist.hpp"
+#include "./flathashtable.hpp"
+
+// a priority queue for small integer priorities (Dial's algorithm),
+// every priority has its own bucket and the smallest non-empty bucket
+// is found by walking forward, so adding and removing are O(1) amortized
+// when the removed priorities only grow, as they do in Dijkstra and A*
+template <typename T, template <typename, typename> class Index = FlatHashtable>
+class BucketQueue
+{
+private:
+    struct Place
+    {
+        int bucket;
+        int index;
+    };
+
+    ArrayList<ArrayList<T>*> buckets;
+    Index<T, Place> places;
+
+    // no bucket before current has items
+    int current;
+    int size;
+    // the most items held at once since the last clear
+    int maxSize;
+
+
+    ArrayList<T>& bucketOf(int p)
+    {
+        while (buckets.getSize() <= p)
+        {
+            ArrayList<T>* bucket = new ArrayList<T>();
+            buckets.push(bucket);
+        }
+        return *buckets.get(p);
+    }
+
+    void push(T& item, int p)
+    {
+        if (p < 0)
+        {
+            throw std::runtime_error("The bucket queue can not hold negative priorities");
+        }
+        ArrayList<T>& bucket = bucketOf(p);
+        places.insert(item, Place{p, bucket.getSize()});
+        bucket.push(item);
+
+        // a smaller priority than the ones removed is still accepted
+        if (p < current) current = p;
+    }
+
+    // takes the item at place out of its bucket by moving the last item there
+    void take(Place place)
+    {
+        ArrayList<T>& bucket = *buckets.get(place.bucket);
+        T& last = bucket.pop();
+        if (place.index < bucket.getSize())
+        {
+            bucket.set(place.index, last);
+            places.insert(bucket.get(place.index), place);
+        }
+    }
+
+    void findSmallest()
+    {
+        while (buckets.get(current)->isEmpty()) current += 1;
+    }
+
+public:
+    BucketQueue()
+    {
+        current = 0;
+        size = 0;
+        maxSize = 0;
+    }
+    ~BucketQueue()
+    {
+        for (int i = 0; i < buckets.getSize(); i += 1) delete buckets.get(i);
+    }
+
+    BucketQueue(const BucketQueue&) = delete;
+    BucketQueue& operator=(const BucketQueue&) = delete;
+
+    bool isEmpty() {return size == 0;}
+
+    bool contains(T& item) {return places.containsKey(item);}
+
+    void add(T& item, int p)
+    {
+        if (contains(item))
+        {
+            throw std::runtime_error("The item is already in the queue");
+        }
+        push(item, p);
+        size += 1;
+        if (size > maxSize) maxSize = size;
+    }
+
+    // moves an item already in the queue to a smaller priority
+    void decreaseKey(T& item, int p)
+    {
+        Place* place = places.find(item);
+        if (place == nullptr)
+        {
+            throw std::runtime_error("The item does not exist in the queue");
+        }
+        if (place->bucket <= p) return;
+
+        T temp = item;
+        take(*place);
+        push(temp, p);
+    }
+
+    // takes an item out of the queue wherever it is
+    void remove(T& item)
+    {
+        Place* place = places.find(item);
+        if (place == nullptr)
+        {
+            throw std::runtime_error("The item does not exist in the queue");
+        }
+
+        T temp = item;
+        take(*place);
+        places.remove(temp);
+        size -= 1;
+    }
+
+    T removeSmallest()
+    {
+        if (isEmpty())
+        {
+            throw std::runtime_error("Can not remove the smallest from an empty queue");
+        }
+        findSmallest();
+
+        ArrayList<T>& bucket = *buckets.get(current);
+        T temp = bucket.pop();
+        places.remove(temp);
+        size -= 1;
+
+        return temp;
+    }
+
+    T& getSmallest()
+    {
+        findSmallest();
+        ArrayList<T>& bucket = *buckets.get(current);
+        return bucket.get(bucket.getSize() - 1);
+    }
+
+    int getSmallestP()
+    {
+        findSmallest();
+        return current;
+    }
+
+    int getSize() {return size;}
+    int getMaxSize() {return maxSize;}
+
+    // the table finding the place of every item
+    Index<T, Place>& getIndex() {return places;}
+
+    void clear()
+    {
+        for (int i = 0; i < buckets.getSize(); i += 1) buckets.get(i)->clear();
+        places.clear();
+        current = 0;
+        size = 0;
+        maxSize = 0;
+    }
+};
+
+#endif
\ No newline at end of file
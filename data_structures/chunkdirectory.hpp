@@ -0,0 +1,117 @@
+#ifndef CHUNK_DIRECTORY_H
+#define CHUNK_DIRECTORY_H
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+
+#include "./arraylist.hpp"
+#include "./flathashtable.hpp"
+
+#define CHUNK_BITS 6
+#define CHUNK_SIZE (1 << CHUNK_BITS)
+#define CHUNK_CELLS (CHUNK_SIZE * CHUNK_SIZE)
+
+// the chunks of an unbounded grid, every chunk covers CHUNK_SIZE squared cells and
+// is only allocated once a cell of it is written, a hashtable maps the chunk
+// coordinates to the chunk
+// lookups usually hit the same chunk as the last one, so every thread keeps
+// the last few chunks it found and skips the hashtable for them
+// the chunks stay until the directory is destroyed, so a cached chunk is
+// never freed under a reader
+template <typename Chunk>
+class ChunkDirectory
+{
+private:
+    struct CachedChunk
+    {
+        uint64_t owner;
+        uint64_t key;
+        // the chunks count when it was cached, a new chunk may replace a
+        // cached miss
+        int chunksNumber;
+        Chunk* chunk;
+    };
+
+    static const int CACHE_SIZE = 4;
+
+    FlatHashtable<uint64_t, Chunk*> directory;
+    ArrayList<Chunk*> chunks;
+
+    // tells the caches of different directories apart, even if one is
+    // allocated where another used to be
+    uint64_t id;
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> ids(0);
+        return ids.fetch_add(1) + 1;
+    }
+
+    static CachedChunk* cacheOf(uint64_t id)
+    {
+        static thread_local CachedChunk cache[CACHE_SIZE] = {};
+        return &cache[id & (CACHE_SIZE - 1)];
+    }
+
+public:
+    ChunkDirectory()
+    {
+        id = nextId();
+    }
+    ~ChunkDirectory()
+    {
+        for (int i = 0; i < chunks.getSize(); i += 1) delete chunks.get(i);
+    }
+
+    ChunkDirectory(const ChunkDirectory&) = delete;
+    ChunkDirectory& operator=(const ChunkDirectory&) = delete;
+
+    // the key of the chunk holding the cell, negative coordinates work too
+    static uint64_t keyOf(int x, int y)
+    {
+        return ((uint64_t)(uint32_t)(x >> CHUNK_BITS) << 32) | (uint32_t)(y >> CHUNK_BITS);
+    }
+
+    // the place of the cell inside its chunk
+    static int indexOf(int x, int y)
+    {
+        return (y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (x & (CHUNK_SIZE - 1));
+    }
+
+    // returns the chunk holding the cell or nullptr if it isn't allocated
+    Chunk* find(int x, int y)
+    {
+        uint64_t key = keyOf(x, y);
+        CachedChunk* cached = cacheOf(id);
+        if (cached->owner == id && cached->key == key && cached->chunksNumber == chunks.getSize())
+        {
+            return cached->chunk;
+        }
+
+        Chunk** found = directory.find(key);
+        Chunk* chunk = found == nullptr ? nullptr : *found;
+        *cached = CachedChunk{id, key, chunks.getSize(), chunk};
+        return chunk;
+    }
+
+    // returns the chunk holding the cell, allocating it if needed
+    Chunk* findOrCreate(int x, int y)
+    {
+        Chunk* chunk = find(x, y);
+        if (chunk != nullptr) return chunk;
+
+        chunk = new Chunk();
+        chunk->x = (x >> CHUNK_BITS) * CHUNK_SIZE;
+        chunk->y = (y >> CHUNK_BITS) * CHUNK_SIZE;
+        directory.insert(keyOf(x, y), chunk);
+        chunks.push(chunk);
+        return chunk;
+    }
+
+    int getSize() {return chunks.getSize();}
+
+    Chunk* get(int i) {return chunks.get(i);}
+};
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef CHUNKED_GRID_H
+#define CHUNKED_GRID_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "./chunkdirectory.hpp"
+
+// the same grid as DenseGrid without any bound, the cells live in chunks
+// allocated the first time one of their cells is written, so the memory
+// follows the touched area, inside a chunk a cell is a single load
+// K needs x and y members, V needs ct (the type) and st (the timestamp)
+//
+// types marked as transient also carry the generation they were written in
+// and disappear together when a new generation starts
+template <typename K, typename V>
+class ChunkedGrid
+{
+private:
+    static const unsigned char EMPTY = 0xFF;
+
+    typedef unsigned short Place;
+
+    struct Chunk
+    {
+        // the first cell of the chunk
+        int x;
+        int y;
+
+        unsigned char types[CHUNK_CELLS];
+        double stamps[CHUNK_CELLS];
+        unsigned int generations[CHUNK_CELLS];
+
+        // the written cells of the chunk, as in DenseGrid
+        Place keys[CHUNK_CELLS];
+        Place slots[CHUNK_CELLS];
+        int written;
+
+        Chunk()
+        {
+            for (int i = 0; i < CHUNK_CELLS; i += 1) types[i] = EMPTY;
+            written = 0;
+        }
+    };
+
+    typedef ChunkDirectory<Chunk> Directory;
+
+    Directory chunks;
+
+    unsigned int generation;
+    unsigned int transientTypes;
+
+    int persistentSize;
+    int transientSize;
+
+    bool isTransient(unsigned char type)
+    {
+        return type < 32 && (transientTypes >> type) & 1;
+    }
+
+    bool isLive(Chunk* chunk, int index)
+    {
+        unsigned char type = chunk->types[index];
+        if (type == EMPTY) return false;
+        return !isTransient(type) || chunk->generations[index] == generation;
+    }
+
+    V valueAt(Chunk* chunk, int index)
+    {
+        V v;
+        v.ct = (decltype(v.ct))chunk->types[index];
+        v.st = chunk->stamps[index];
+        return v;
+    }
+
+    void count(unsigned char type, int n)
+    {
+        if (isTransient(type)) transientSize += n;
+        else persistentSize += n;
+    }
+
+public:
+    ChunkedGrid()
+    {
+        generation = 1;
+        transientTypes = 0;
+        persistentSize = 0;
+        transientSize = 0;
+    }
+
+    ChunkedGrid(const ChunkedGrid&) = delete;
+    ChunkedGrid& operator=(const ChunkedGrid&) = delete;
+
+    // cells of this type are removed by clearTransient
+    void markTransient(int type)
+    {
+        transientTypes |= 1u << type;
+    }
+
+    void insert(K k, V v)
+    {
+        Chunk* chunk = chunks.findOrCreate(k.x, k.y);
+        int index = Directory::indexOf(k.x, k.y);
+
+        if (chunk->types[index] == EMPTY)
+        {
+            chunk->slots[index] = chunk->written;
+            chunk->keys[chunk->written] = index;
+            chunk->written += 1;
+        }
+        else if (isLive(chunk, index)) count(chunk->types[index], -1);
+
+        chunk->types[index] = (unsigned char)v.ct;
+        chunk->stamps[index] = v.st;
+        chunk->generations[index] = generation;
+        count(chunk->types[index], 1);
+    }
+
+    bool containsKey(K k)
+    {
+        Chunk* chunk = chunks.find(k.x, k.y);
+        return chunk != nullptr && isLive(chunk, Directory::indexOf(k.x, k.y));
+    }
+
+    // returns the type of the cell or -1 if the cell is empty
+    int typeOf(K k)
+    {
+        Chunk* chunk = chunks.find(k.x, k.y);
+        if (chunk == nullptr) return -1;
+        int index = Directory::indexOf(k.x, k.y);
+        return isLive(chunk, index) ? chunk->types[index] : -1;
+    }
+
+    V get(K k)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        return valueAt(chunks.find(k.x, k.y), Directory::indexOf(k.x, k.y));
+    }
+
+    void set(K& k, V& v)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        insert(k, v);
+    }
+
+    V remove(K k)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        Chunk* chunk = chunks.find(k.x, k.y);
+        int index = Directory::indexOf(k.x, k.y);
+        V temp = valueAt(chunk, index);
+        count(chunk->types[index], -1);
+
+        // move the last written cell to the place of the removed one
+        int last = chunk->keys[chunk->written - 1];
+        chunk->keys[chunk->slots[index]] = last;
+        chunk->slots[last] = chunk->slots[index];
+        chunk->written -= 1;
+
+        chunk->types[index] = EMPTY;
+        return temp;
+    }
+
+    // removes every transient cell by starting a new generation
+    void clearTransient()
+    {
+        generation += 1;
+        if (generation == 0)
+        {
+            for (int c = 0; c < chunks.getSize(); c += 1)
+            {
+                Chunk* chunk = chunks.get(c);
+                for (int i = 0; i < CHUNK_CELLS; i += 1) chunk->generations[i] = 0;
+            }
+            generation = 1;
+        }
+        transientSize = 0;
+    }
+
+    // only the written cells are touched, the chunks stay allocated
+    void clear()
+    {
+        for (int c = 0; c < chunks.getSize(); c += 1)
+        {
+            Chunk* chunk = chunks.get(c);
+            for (int i = 0; i < chunk->written; i += 1) chunk->types[chunk->keys[i]] = EMPTY;
+            chunk->written = 0;
+        }
+        persistentSize = 0;
+        transientSize = 0;
+    }
+
+    int getSize() {return persistentSize + transientSize;}
+
+    int getChunksNumber() {return chunks.getSize();}
+
+    class HashIterator
+    {
+    private:
+
+        ChunkedGrid<K, V>* grid;
+
+        // the chunk and the place in its keys of the next live cell
+        int chunk;
+        int place;
+
+        K key;
+        V value;
+
+        void skipDead()
+        {
+            while (chunk < grid->chunks.getSize())
+            {
+                Chunk* c = grid->chunks.get(chunk);
+                while (place < c->written && !grid->isLive(c, c->keys[place])) place += 1;
+                if (place < c->written) return;
+
+                chunk += 1;
+                place = 0;
+            }
+        }
+    public:
+
+        HashIterator()
+        {
+            grid = nullptr;
+            chunk = 0;
+            place = 0;
+        }
+        void begin(ChunkedGrid<K, V>& g)
+        {
+            grid = &g;
+            chunk = 0;
+            place = 0;
+            skipDead();
+        }
+
+        void next()
+        {
+            if (!hasNext())
+            {
+                throw std::runtime_error("The iterator has no next value");
+            }
+
+            Chunk* c = grid->chunks.get(chunk);
+            int index = c->keys[place];
+            key.x = c->x + index % CHUNK_SIZE;
+            key.y = c->y + index / CHUNK_SIZE;
+            value = grid->valueAt(c, index);
+
+            place += 1;
+            skipDead();
+        }
+
+        bool hasNext()
+        {
+            return chunk < grid->chunks.getSize();
+        }
+
+        V& getValue()
+        {
+            return value;
+        }
+
+        K& getKey()
+        {
+            return key;
+        }
+
+    };
+
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef CHUNKED_STAMPED_GRID_H
+#define CHUNKED_STAMPED_GRID_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "./chunkdirectory.hpp"
+
+// the same table as StampedGrid without any bound, the values live in
+// chunks allocated the first time one of their cells is written
+// values of older generations count as removed, so clearing the whole
+// table is a single increment and the chunks are kept for the next search
+// K needs x and y members
+template <typename K, typename V>
+class ChunkedStampedGrid
+{
+private:
+    struct Chunk
+    {
+        // the first cell of the chunk
+        int x;
+        int y;
+
+        V values[CHUNK_CELLS];
+        unsigned int stamps[CHUNK_CELLS];
+
+        Chunk()
+        {
+            for (int i = 0; i < CHUNK_CELLS; i += 1) stamps[i] = 0;
+        }
+    };
+
+    typedef ChunkDirectory<Chunk> Directory;
+
+    Directory chunks;
+    unsigned int generation;
+    int size;
+
+    // the value of the key if it was written in this generation
+    V* current(K& k)
+    {
+        Chunk* chunk = chunks.find(k.x, k.y);
+        if (chunk == nullptr) return nullptr;
+        int index = Directory::indexOf(k.x, k.y);
+        return chunk->stamps[index] == generation ? &chunk->values[index] : nullptr;
+    }
+
+public:
+    ChunkedStampedGrid()
+    {
+        generation = 1;
+        size = 0;
+    }
+
+    ChunkedStampedGrid(const ChunkedStampedGrid&) = delete;
+    ChunkedStampedGrid& operator=(const ChunkedStampedGrid&) = delete;
+
+    void insert(K k, V v)
+    {
+        Chunk* chunk = chunks.findOrCreate(k.x, k.y);
+        int index = Directory::indexOf(k.x, k.y);
+
+        if (chunk->stamps[index] != generation)
+        {
+            chunk->stamps[index] = generation;
+            size += 1;
+        }
+        chunk->values[index] = v;
+    }
+
+    bool containsKey(K k)
+    {
+        return current(k) != nullptr;
+    }
+
+    // returns a pointer to the value of the key or nullptr if it doesn't exist
+    V* find(K k)
+    {
+        return current(k);
+    }
+
+    V get(K k)
+    {
+        V* value = current(k);
+        if (value == nullptr)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        return *value;
+    }
+
+    void set(K& k, V& v)
+    {
+        V* value = current(k);
+        if (value == nullptr)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        *value = v;
+    }
+
+    V remove(K k)
+    {
+        if (current(k) == nullptr)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        Chunk* chunk = chunks.find(k.x, k.y);
+        int index = Directory::indexOf(k.x, k.y);
+        chunk->stamps[index] = 0;
+        size -= 1;
+        return chunk->values[index];
+    }
+
+    // starts a new generation, the stamps are only rewritten
+    // when the counter wraps around
+    void clear()
+    {
+        generation += 1;
+        if (generation == 0)
+        {
+            for (int c = 0; c < chunks.getSize(); c += 1)
+            {
+                Chunk* chunk = chunks.get(c);
+                for (int i = 0; i < CHUNK_CELLS; i += 1) chunk->stamps[i] = 0;
+            }
+            generation = 1;
+        }
+        size = 0;
+    }
+
+    int getSize() {return size;}
+
+    int getChunksNumber() {return chunks.getSize();}
+};
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef DENSE_GRID_H
+#define DENSE_GRID_H
+
+#include <iostream>
+#include <stdexcept>
+
+// a fixed W * H grid stored row-major, every cell keeps a one byte type
+// and a timestamp in a separate plane, so checking a cell is one load
+// K needs x and y members, V needs ct (the type) and st (the timestamp)
+//
+// types marked as transient also carry the generation they were written in
+// and disappear together when a new generation starts
+template <typename K, typename V, int W, int H>
+class DenseGrid
+{
+private:
+    static const unsigned char EMPTY = 0xFF;
+
+    unsigned char* types;
+    double* stamps;
+    unsigned int* generations;
+
+    unsigned int generation;
+    unsigned int transientTypes;
+
+    // the indices of the written cells, so iterating doesn't scan the grid
+    // slots holds the place of every written cell inside keys
+    // transient cells of older generations stay here until they are reused
+    int* keys;
+    int* slots;
+    int written;
+
+    int persistentSize;
+    int transientSize;
+
+    bool isInside(K& k)
+    {
+        return k.x >= 0 && k.y >= 0 && k.x < W && k.y < H;
+    }
+
+    int indexOf(K& k)
+    {
+        return k.y * W + k.x;
+    }
+
+    bool isTransient(unsigned char type)
+    {
+        return type < 32 && (transientTypes >> type) & 1;
+    }
+
+    bool isLive(int index)
+    {
+        unsigned char type = types[index];
+        if (type == EMPTY) return false;
+        return !isTransient(type) || generations[index] == generation;
+    }
+
+    V valueAt(int index)
+    {
+        V v;
+        v.ct = (decltype(v.ct))types[index];
+        v.st = stamps[index];
+        return v;
+    }
+
+    void count(unsigned char type, int n)
+    {
+        if (isTransient(type)) transientSize += n;
+        else persistentSize += n;
+    }
+
+public:
+    DenseGrid()
+    {
+        types = new unsigned char[W * H];
+        stamps = new double[W * H];
+        generations = new unsigned int[W * H];
+        keys = new int[W * H];
+        slots = new int[W * H];
+
+        for (int i = 0; i < W * H; i += 1) types[i] = EMPTY;
+        generation = 1;
+        transientTypes = 0;
+        written = 0;
+        persistentSize = 0;
+        transientSize = 0;
+    }
+    ~DenseGrid()
+    {
+        delete [] types;
+        delete [] stamps;
+        delete [] generations;
+        delete [] keys;
+        delete [] slots;
+    }
+
+    DenseGrid(const DenseGrid&) = delete;
+    DenseGrid& operator=(const DenseGrid&) = delete;
+
+    // cells of this type are removed by clearTransient
+    void markTransient(int type)
+    {
+        transientTypes |= 1u << type;
+    }
+
+    void insert(K k, V v)
+    {
+        if (!isInside(k))
+        {
+            throw std::runtime_error("The key is outside of the grid");
+        }
+        int index = indexOf(k);
+
+        if (types[index] == EMPTY)
+        {
+            slots[index] = written;
+            keys[written] = index;
+            written += 1;
+        }
+        else if (isLive(index)) count(types[index], -1);
+
+        types[index] = (unsigned char)v.ct;
+        stamps[index] = v.st;
+        generations[index] = generation;
+        count(types[index], 1);
+    }
+
+    bool containsKey(K k)
+    {
+        return isInside(k) && isLive(indexOf(k));
+    }
+
+    // returns the type of the cell or -1 if the cell is empty
+    int typeOf(K k)
+    {
+        if (!isInside(k)) return -1;
+        int index = indexOf(k);
+        return isLive(index) ? types[index] : -1;
+    }
+
+    V get(K k)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        return valueAt(indexOf(k));
+    }
+
+    void set(K& k, V& v)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        insert(k, v);
+    }
+
+    V remove(K k)
+    {
+        if (!containsKey(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        int index = indexOf(k);
+        V temp = valueAt(index);
+        count(types[index], -1);
+
+        // move the last written cell to the place of the removed one
+        int last = keys[written - 1];
+        keys[slots[index]] = last;
+        slots[last] = slots[index];
+        written -= 1;
+
+        types[index] = EMPTY;
+        return temp;
+    }
+
+    // removes every transient cell by starting a new generation
+    void clearTransient()
+    {
+        generation += 1;
+        if (generation == 0)
+        {
+            for (int i = 0; i < W * H; i += 1) generations[i] = 0;
+            generation = 1;
+        }
+        transientSize = 0;
+    }
+
+    // only the written cells are touched
+    void clear()
+    {
+        for (int i = 0; i < written; i += 1) types[keys[i]] = EMPTY;
+        written = 0;
+        persistentSize = 0;
+        transientSize = 0;
+    }
+
+    int getSize() {return persistentSize + transientSize;}
+
+    class HashIterator
+    {
+    private:
+
+        DenseGrid<K, V, W, H>* grid;
+
+        // the place in keys of the next live cell
+        int place;
+
+        K key;
+        V value;
+
+        void skipDead()
+        {
+            while (place < grid->written && !grid->isLive(grid->keys[place])) place += 1;
+        }
+    public:
+
+        HashIterator()
+        {
+            grid = nullptr;
+            place = 0;
+        }
+        void begin(DenseGrid<K, V, W, H>& g)
+        {
+            grid = &g;
+            place = 0;
+            skipDead();
+        }
+
+        void next()
+        {
+            if (!hasNext())
+            {
+                throw std::runtime_error("The iterator has no next value");
+            }
+
+            int index = grid->keys[place];
+            key.x = index % W;
+            key.y = index / W;
+            value = grid->valueAt(index);
+
+            place += 1;
+            skipDead();
+        }
+
+        bool hasNext()
+        {
+            return place < grid->written;
+        }
+
+        V& getValue()
+        {
+            return value;
+        }
+
+        K& getKey()
+        {
+            return key;
+        }
+
+    };
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,295 @@
+#ifndef FLAT_HASH_TABLE_H
+#define FLAT_HASH_TABLE_H
+
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+
+// an open-addressing hashtable using robin-hood probing,
+// entries live in one array so a lookup doesn't chase any pointers
+template <typename K, typename V>
+class FlatHashtable
+{
+private:
+
+    class HashNode
+    {
+    public:
+        K key;
+        V value;
+        // how far the node is from the place its hash points to, -1 if empty
+        int distance;
+
+        HashNode() {distance = -1;}
+    };
+
+    HashNode* nodes;
+    int size;
+    int length;
+    int shift;
+
+    // the keys compared and the resizes since the last clear, and the
+    // farthest a node was put from its place, removals don't lower it
+    long probes;
+    int rehashes;
+    int longestProbe;
+
+    std::hash<K> h;
+
+
+    // the hash is multiplied by the golden ratio and the top bits are taken,
+    // so keys with weak hashes are still spread over the whole table
+    int hash(K& key)
+    {
+        uint64_t x = (uint64_t)h(key) * 0x9E3779B97F4A7C15ULL;
+        return (int)(x >> shift);
+    }
+
+    int nextIndex(int index)
+    {
+        return (index + 1) & (length - 1);
+    }
+
+    void allocate(int newLength)
+    {
+        length = newLength;
+        shift = 64;
+        for (int l = length; l > 1; l /= 2) shift -= 1;
+
+        nodes = new HashNode[length];
+        size = 0;
+    }
+
+    void resize(float factor)
+    {
+        int oldLength = length;
+        HashNode* temp = nodes;
+        allocate(length * factor);
+        rehashes += 1;
+        longestProbe = 0;
+
+        for (int i = 0; i < oldLength; i += 1)
+        {
+            if (temp[i].distance != -1) insert(temp[i].key, temp[i].value);
+        }
+        delete [] temp;
+    }
+
+    // returns the index of the key or -1 if it doesn't exist
+    int indexOf(K& k)
+    {
+        int index = hash(k);
+
+        // a node closer to its place than the distance walked means
+        // the key would have been put before it
+        for (int distance = 0; nodes[index].distance >= distance; distance += 1)
+        {
+            probes += 1;
+            if (nodes[index].key == k) return index;
+            index = nextIndex(index);
+        }
+        return -1;
+    }
+
+public:
+    FlatHashtable()
+    {
+        allocate(8);
+        resetStats();
+    }
+    ~FlatHashtable()
+    {
+        delete [] nodes;
+    }
+
+    FlatHashtable(const FlatHashtable&) = delete;
+    FlatHashtable& operator=(const FlatHashtable&) = delete;
+
+    void insert(K k, V v)
+    {
+        if ((float)(size + 1) / (float)length >= 0.75)
+        {
+            resize(2);
+        }
+
+        int index = hash(k);
+        int distance = 0;
+
+        while (true)
+        {
+            HashNode& node = nodes[index];
+            if (distance > longestProbe) longestProbe = distance;
+            if (node.distance == -1)
+            {
+                node.key = k;
+                node.value = v;
+                node.distance = distance;
+                size += 1;
+                return;
+            }
+            probes += 1;
+            if (node.key == k)
+            {
+                node.value = v;
+                return;
+            }
+            // the richer node gives its place to the poorer one
+            if (node.distance < distance)
+            {
+                K tempKey = node.key;
+                V tempValue = node.value;
+                int tempDistance = node.distance;
+
+                node.key = k;
+                node.value = v;
+                node.distance = distance;
+
+                k = tempKey;
+                v = tempValue;
+                distance = tempDistance;
+            }
+            index = nextIndex(index);
+            distance += 1;
+        }
+    }
+
+    bool containsKey(K k)
+    {
+        return indexOf(k) != -1;
+    }
+
+    // returns a pointer to the value of the key or nullptr if it doesn't exist
+    V* find(K k)
+    {
+        int index = indexOf(k);
+        return index == -1 ? nullptr : &nodes[index].value;
+    }
+
+    V get(K k)
+    {
+        int index = indexOf(k);
+        if (index == -1)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        return nodes[index].value;
+    }
+
+    void set(K& k, V& v)
+    {
+        int index = indexOf(k);
+        if (index == -1)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        nodes[index].value = v;
+    }
+
+    V remove(K k)
+    {
+        if (length > 32 && ((float)size / (float)length) < 0.25)
+        {
+            resize(0.5);
+        }
+
+        int index = indexOf(k);
+        if (index == -1)
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        V temp = nodes[index].value;
+
+        // shift the following nodes back instead of leaving a tombstone
+        int next = nextIndex(index);
+        while (nodes[next].distance > 0)
+        {
+            nodes[index] = nodes[next];
+            nodes[index].distance -= 1;
+            index = next;
+            next = nextIndex(next);
+        }
+        nodes[index].distance = -1;
+        size -= 1;
+
+        return temp;
+    }
+
+    void clear()
+    {
+        delete [] nodes;
+        allocate(8);
+        resetStats();
+    }
+
+    int getSize() {return size;}
+
+    long getProbes() {return probes;}
+    int getRehashes() {return rehashes;}
+    // the most slots a lookup may walk, the longest bucket of the table
+    int getLongestBucket() {return longestProbe + 1;}
+
+    void resetStats()
+    {
+        probes = 0;
+        rehashes = 0;
+        longestProbe = 0;
+    }
+
+    class HashIterator
+    {
+    private:
+
+        FlatHashtable<K, V>* ht;
+
+        int index;
+
+        int counter;
+    public:
+
+        HashIterator()
+        {
+            ht = nullptr;
+            index = -1;
+            counter = 0;
+        }
+        void begin(FlatHashtable<K, V>& htable)
+        {
+            ht = &htable;
+            index = -1;
+            counter = 0;
+        }
+
+        void next()
+        {
+            if (counter >= ht->size)
+            {
+                throw std::runtime_error("The iterator has no next value");
+            }
+
+            do
+            {
+                index += 1;
+            } while (ht->nodes[index].distance == -1);
+            counter += 1;
+        }
+
+        bool hasNext()
+        {
+            return counter < ht->size;
+        }
+
+        V& getValue()
+        {
+            return ht->nodes[index].value;
+        }
+
+        K& getKey()
+        {
+            return ht->nodes[index].key;
+        }
+
+    };
+
+};
+
+#endif
\ No newline at end of file
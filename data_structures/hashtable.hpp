@@ -30,6 +30,12 @@ private:
     int size;
     int length;
 
+    // the keys compared and the resizes since the last clear, and the
+    // most nodes a bucket had, removals don't lower it
+    long probes;
+    int rehashes;
+    int longestBucket;
+
     std::hash<K> h;
 
 
@@ -41,6 +47,8 @@ private:
     void resize(float factor)
     {
         length *= factor;
+        rehashes += 1;
+        longestBucket = 0;
         ArrayList<HashNode>* temp = arrays;
         arrays = new ArrayList<HashNode>[length];
 
@@ -69,6 +77,7 @@ public:
         length = 4;
 
         arrays = new ArrayList<HashNode>[length];
+        resetStats();
     }
     ~Hashtable()
     {
@@ -87,6 +96,7 @@ public:
 
         for (int i = 0; i < arrays[index].getSize(); i += 1)
         {
+            probes += 1;
             if (k == arrays[index].get(i).getKey())
             {
                 arrays[index].get(i).setValue(v);
@@ -94,6 +104,7 @@ public:
             }
         }
         arrays[index].push(n);
+        if (arrays[index].getSize() > longestBucket) longestBucket = arrays[index].getSize();
         
         size += 1;
     }
@@ -104,6 +115,7 @@ public:
 
         for (int i = 0; i < arrays[index].getSize(); i += 1)
         {
+            probes += 1;
             if (arrays[index].get(i).getKey() == k)
             {
                 return true;
@@ -113,12 +125,29 @@ public:
     }
 
 
+    // returns a pointer to the value of the key or nullptr if it doesn't exist
+    V* find(K k)
+    {
+        int index = hash(k);
+
+        for (int i = 0; i < arrays[index].getSize(); i += 1)
+        {
+            probes += 1;
+            if (arrays[index].get(i).getKey() == k)
+            {
+                return &arrays[index].get(i).getValue();
+            }
+        }
+        return nullptr;
+    }
+
     V get(K k)
     {
         int index = hash(k);
 
         for (int i = 0; i < arrays[index].getSize(); i += 1)
         {
+            probes += 1;
             if (arrays[index].get(i).getKey() == k)
             {
                 return arrays[index].get(i).getValue();
@@ -133,6 +162,7 @@ public:
 
         for (int i = 0; i < arrays[index].getSize(); i += 1)
         {
+            probes += 1;
             if (arrays[index].get(i).getKey() == k)
             {
                 arrays[index].get(i).setValue(v);
@@ -152,6 +182,7 @@ public:
         int index = hash(k);
         for (int i = 0; i < arrays[index].getSize(); i += 1)
         {
+            probes += 1;
             if (arrays[index].get(i).getKey() == k)
             {
                 // set the deleted element to the last element
@@ -173,10 +204,22 @@ public:
         size = 0;
         length = 4;
         arrays = new ArrayList<HashNode>[length];
+        resetStats();
     }
 
     int getSize() {return size;}
 
+    long getProbes() {return probes;}
+    int getRehashes() {return rehashes;}
+    int getLongestBucket() {return longestBucket;}
+
+    void resetStats()
+    {
+        probes = 0;
+        rehashes = 0;
+        longestBucket = 0;
+    }
+
     class HashIterator
     {
     private:
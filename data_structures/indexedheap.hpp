@@ -0,0 +1,247 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+#include "./flathashtable.hpp"
+
+#define HEAP_ARITY 4
+#define CACHE_LINE 64
+
+// a 4-ary min heap that knows where every item is,
+// so the priority of an item already in it can be decreased
+// Index is the table mapping every item to its place in the heap
+template <typename T, typename P = float, template <typename, typename> class Index = FlatHashtable>
+class IndexedHeap
+{
+private:
+    struct alignas(16) HeapNode
+    {
+        T item;
+        P priority;
+    };
+
+    // the nodes are shifted by OFFSET so the children of every node
+    // start at a cache line and share it
+    static const int OFFSET = HEAP_ARITY - 1;
+
+    HeapNode* nodes;
+    int size;
+    int length;
+    // the most items held at once since the last clear
+    int maxSize;
+
+    Index<T, int> places;
+
+
+    HeapNode* allocate(int n)
+    {
+        void* memory = ::operator new[]((n + OFFSET) * sizeof(HeapNode), std::align_val_t(CACHE_LINE));
+        HeapNode* temp = static_cast<HeapNode*>(memory);
+        for (int i = 0; i < n + OFFSET; i += 1) new (&temp[i]) HeapNode();
+        return temp + OFFSET;
+    }
+
+    void deallocate(HeapNode* n, int l)
+    {
+        HeapNode* start = n - OFFSET;
+        for (int i = 0; i < l + OFFSET; i += 1) start[i].~HeapNode();
+        ::operator delete[](start, std::align_val_t(CACHE_LINE));
+    }
+
+    void resizeUp()
+    {
+        HeapNode* temp = nodes;
+        nodes = allocate(length * 2);
+
+        for (int i = 0; i < size; i += 1)
+        {
+            nodes[i] = temp[i];
+        }
+        deallocate(temp, length);
+        length *= 2;
+    }
+
+
+    int parentOf(int child)
+    {
+        return (child - 1) / HEAP_ARITY;
+    }
+
+    int firstChild(int parent)
+    {
+        return HEAP_ARITY * parent + 1;
+    }
+
+    // puts the node at index and remembers its place
+    void place(int index, HeapNode& node)
+    {
+        nodes[index] = node;
+        places.insert(node.item, index);
+    }
+
+    void swimUp(int child)
+    {
+        HeapNode node = nodes[child];
+
+        while (child > 0)
+        {
+            int parent = parentOf(child);
+            if (!(node.priority < nodes[parent].priority)) break;
+
+            place(child, nodes[parent]);
+            child = parent;
+        }
+        place(child, node);
+    }
+
+    void sinkDown(int parent)
+    {
+        HeapNode node = nodes[parent];
+
+        while (true)
+        {
+            int first = firstChild(parent);
+            if (first >= size) break;
+
+            int last = first + HEAP_ARITY < size ? first + HEAP_ARITY : size;
+
+            // finding the smallest child
+            int smallest = first;
+            for (int i = first + 1; i < last; i += 1)
+            {
+                if (nodes[i].priority < nodes[smallest].priority) smallest = i;
+            }
+
+            if (!(nodes[smallest].priority < node.priority)) break;
+
+            place(parent, nodes[smallest]);
+            parent = smallest;
+        }
+        place(parent, node);
+    }
+
+public:
+    IndexedHeap()
+    {
+        size = 0;
+        maxSize = 0;
+        length = 16;
+        nodes = allocate(length);
+    }
+    ~IndexedHeap()
+    {
+        deallocate(nodes, length);
+    }
+
+    IndexedHeap(const IndexedHeap&) = delete;
+    IndexedHeap& operator=(const IndexedHeap&) = delete;
+
+    bool isEmpty() {return size == 0;}
+
+    bool contains(T& item) {return places.containsKey(item);}
+
+    void add(T& item, P p)
+    {
+        if (contains(item))
+        {
+            throw std::runtime_error("The item is already in the heap");
+        }
+        if (size == length)
+        {
+            resizeUp();
+        }
+
+        nodes[size].item = item;
+        nodes[size].priority = p;
+        size += 1;
+        if (size > maxSize) maxSize = size;
+
+        swimUp(size - 1);
+    }
+
+    // lowers the priority of an item already in the heap
+    void decreaseKey(T& item, P p)
+    {
+        int* index = places.find(item);
+        if (index == nullptr)
+        {
+            throw std::runtime_error("The item does not exist in the heap");
+        }
+        if (nodes[*index].priority < p) return;
+
+        nodes[*index].priority = p;
+        swimUp(*index);
+    }
+
+    // takes an item out of the heap wherever it is
+    void remove(T& item)
+    {
+        int* found = places.find(item);
+        if (found == nullptr)
+        {
+            throw std::runtime_error("The item does not exist in the heap");
+        }
+
+        int index = *found;
+        T temp = item;
+        places.remove(temp);
+
+        size -= 1;
+        if (index < size)
+        {
+            nodes[index] = nodes[size];
+            if (index > 0 && nodes[index].priority < nodes[parentOf(index)].priority) swimUp(index);
+            else sinkDown(index);
+        }
+    }
+
+    T removeSmallest()
+    {
+        if (isEmpty())
+        {
+            throw std::runtime_error("Can not remove the smallest from an empty Heap");
+        }
+
+        T temp = nodes[0].item;
+        places.remove(temp);
+
+        size -= 1;
+        if (size > 0)
+        {
+            nodes[0] = nodes[size];
+            sinkDown(0);
+        }
+
+        return temp;
+    }
+
+    T& getSmallest()
+    {
+        return nodes[0].item;
+    }
+
+    P getSmallestP()
+    {
+        return nodes[0].priority;
+    }
+
+    T& get(int i) {return nodes[i].item;}
+    P getP(int i) {return nodes[i].priority;}
+    int getSize() {return size;}
+    int getMaxSize() {return maxSize;}
+
+    // the table finding the place of every item
+    Index<T, int>& getIndex() {return places;}
+
+    void clear()
+    {
+        size = 0;
+        maxSize = 0;
+        places.clear();
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "./flathashtable.hpp"
+
+// a cache of at most capacity values, once it's full the value used
+// the longest time ago makes room for the new one
+// the values live in one array linked from the most to the least recently
+// used, a hashtable maps every key to its place in the array
+template <typename K, typename V>
+class LRUCache
+{
+private:
+    struct Node
+    {
+        K key;
+        V value;
+        int newer;
+        int older;
+    };
+
+    Node* nodes;
+    int capacity;
+    int size;
+
+    // the most and the least recently used nodes, -1 while empty
+    int newest;
+    int oldest;
+
+    FlatHashtable<K, int> places;
+
+
+    void unlink(int index)
+    {
+        Node& node = nodes[index];
+        if (node.newer != -1) nodes[node.newer].older = node.older;
+        else newest = node.older;
+
+        if (node.older != -1) nodes[node.older].newer = node.newer;
+        else oldest = node.newer;
+    }
+
+    void linkNewest(int index)
+    {
+        nodes[index].newer = -1;
+        nodes[index].older = newest;
+        if (newest != -1) nodes[newest].newer = index;
+        newest = index;
+        if (oldest == -1) oldest = index;
+    }
+
+public:
+    LRUCache(int c)
+    {
+        if (c <= 0)
+        {
+            throw std::runtime_error("The cache needs room for one value at least");
+        }
+        capacity = c;
+        nodes = new Node[capacity];
+        size = 0;
+        newest = -1;
+        oldest = -1;
+    }
+    ~LRUCache()
+    {
+        delete [] nodes;
+    }
+
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    // returns a pointer to the value of the key or nullptr if it isn't
+    // cached, a found value becomes the most recently used
+    V* find(K k)
+    {
+        int* index = places.find(k);
+        if (index == nullptr) return nullptr;
+
+        unlink(*index);
+        linkNewest(*index);
+        return &nodes[*index].value;
+    }
+
+    // returns the value of the key to be filled in, the value is the one
+    // already cached or the one of the least recently used key it replaces
+    V& put(K k)
+    {
+        int* place = places.find(k);
+        int index;
+        if (place != nullptr)
+        {
+            index = *place;
+            unlink(index);
+        }
+        else if (size < capacity)
+        {
+            index = size;
+            size += 1;
+            places.insert(k, index);
+        }
+        else
+        {
+            index = oldest;
+            unlink(index);
+            places.remove(nodes[index].key);
+            places.insert(k, index);
+        }
+        nodes[index].key = k;
+        linkNewest(index);
+        return nodes[index].value;
+    }
+
+    bool containsKey(K k)
+    {
+        return places.containsKey(k);
+    }
+
+    // forgets every key, the values stay allocated for reuse
+    void clear()
+    {
+        places.clear();
+        size = 0;
+        newest = -1;
+        oldest = -1;
+    }
+
+    int getSize() {return size;}
+    int getCapacity() {return capacity;}
+};
+
+#endif
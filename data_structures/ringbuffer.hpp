@@ -0,0 +1,60 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <iostream>
+#include <stdexcept>
+
+// keeps the last items pushed, up to a fixed capacity, a push to a full
+// buffer overwrites the oldest item, nothing is allocated after creation
+template <typename T>
+class RingBuffer
+{
+private:
+    T* items;
+    int capacity;
+    // every push ever made, the newest item is at (pushed - 1) % capacity
+    long pushed;
+
+public:
+    RingBuffer(int capacity)
+    {
+        if (capacity <= 0)
+        {
+            throw std::runtime_error("The capacity of the ring has to be positive");
+        }
+        this->capacity = capacity;
+        items = new T[capacity];
+        pushed = 0;
+    }
+    ~RingBuffer()
+    {
+        delete [] items;
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    void push(const T& item)
+    {
+        items[pushed % capacity] = item;
+        pushed += 1;
+    }
+
+    // the i-th oldest item kept
+    T& get(int i)
+    {
+        long first = pushed - getSize();
+        return items[(first + i) % capacity];
+    }
+
+    int getSize() {return pushed < capacity ? (int)pushed : capacity;}
+    int getCapacity() {return capacity;}
+    bool isEmpty() {return pushed == 0;}
+
+    void clear()
+    {
+        pushed = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+
+// a queue of a fixed capacity for one thread pushing and one other thread
+// popping, neither of them ever waits for the other or takes a lock
+// each side keeps the last position it saw of the other, so the shared
+// positions are only read again when the queue looks full or empty
+// the capacity has to be a power of two
+template <typename T>
+class SPSCRing
+{
+private:
+    T* items;
+    unsigned int capacity;
+    unsigned int mask;
+
+    // the positions keep growing and wrap around on their own, their
+    // difference is the size, every one is on its own cache line so the
+    // two threads don't write the same line
+    alignas(64) std::atomic<unsigned int> head;
+    alignas(64) std::atomic<unsigned int> tail;
+
+    // the producer's last view of head and the consumer's last view of tail
+    alignas(64) unsigned int knownHead;
+    alignas(64) unsigned int knownTail;
+
+public:
+    SPSCRing(int capacity)
+    {
+        if (capacity <= 0 || (capacity & (capacity - 1)) != 0)
+        {
+            throw std::runtime_error("The capacity of the ring has to be a power of two");
+        }
+        this->capacity = capacity;
+        mask = capacity - 1;
+        items = new T[capacity];
+        head = 0;
+        tail = 0;
+        knownHead = 0;
+        knownTail = 0;
+    }
+    ~SPSCRing()
+    {
+        delete [] items;
+    }
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    // called by the producer only, returns false if the ring is full
+    bool push(const T& item)
+    {
+        unsigned int position = tail.load(std::memory_order_relaxed);
+        if (position - knownHead == capacity)
+        {
+            knownHead = head.load(std::memory_order_acquire);
+            if (position - knownHead == capacity) return false;
+        }
+        items[position & mask] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // called by the consumer only, returns false if the ring is empty
+    bool pop(T* item)
+    {
+        unsigned int position = head.load(std::memory_order_relaxed);
+        if (position == knownTail)
+        {
+            knownTail = tail.load(std::memory_order_acquire);
+            if (position == knownTail) return false;
+        }
+        *item = items[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only while neither thread uses the ring
+    void clear()
+    {
+        head = 0;
+        tail = 0;
+        knownHead = 0;
+        knownTail = 0;
+    }
+
+    // exact only while neither thread uses the ring
+    int getSize()
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    int getCapacity() {return capacity;}
+};
+
+#endif
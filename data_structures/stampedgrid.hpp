@@ -0,0 +1,127 @@
+#ifndef STAMPED_GRID_H
+#define STAMPED_GRID_H
+
+#include <iostream>
+#include <stdexcept>
+
+// a table over a fixed W * H grid where every value carries the generation
+// it was written in, values of older generations count as removed,
+// so clearing the whole table is a single increment
+// K needs x and y members
+template <typename K, typename V, int W, int H>
+class StampedGrid
+{
+private:
+    V* values;
+    unsigned int* stamps;
+    unsigned int generation;
+    int size;
+
+    bool isInside(K& k)
+    {
+        return k.x >= 0 && k.y >= 0 && k.x < W && k.y < H;
+    }
+
+    int indexOf(K& k)
+    {
+        return k.y * W + k.x;
+    }
+
+    bool isCurrent(K& k)
+    {
+        return isInside(k) && stamps[indexOf(k)] == generation;
+    }
+
+public:
+    StampedGrid()
+    {
+        values = new V[W * H];
+        stamps = new unsigned int[W * H];
+
+        for (int i = 0; i < W * H; i += 1) stamps[i] = 0;
+        generation = 1;
+        size = 0;
+    }
+    ~StampedGrid()
+    {
+        delete [] values;
+        delete [] stamps;
+    }
+
+    StampedGrid(const StampedGrid&) = delete;
+    StampedGrid& operator=(const StampedGrid&) = delete;
+
+    void insert(K k, V v)
+    {
+        if (!isInside(k))
+        {
+            throw std::runtime_error("The key is outside of the grid");
+        }
+        int index = indexOf(k);
+
+        if (stamps[index] != generation)
+        {
+            stamps[index] = generation;
+            size += 1;
+        }
+        values[index] = v;
+    }
+
+    bool containsKey(K k)
+    {
+        return isCurrent(k);
+    }
+
+    // returns a pointer to the value of the key or nullptr if it doesn't exist
+    V* find(K k)
+    {
+        return isCurrent(k) ? &values[indexOf(k)] : nullptr;
+    }
+
+    V get(K k)
+    {
+        if (!isCurrent(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        return values[indexOf(k)];
+    }
+
+    void set(K& k, V& v)
+    {
+        if (!isCurrent(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        values[indexOf(k)] = v;
+    }
+
+    V remove(K k)
+    {
+        if (!isCurrent(k))
+        {
+            throw std::runtime_error("The item with the key value does not exist in the table");
+        }
+        int index = indexOf(k);
+        stamps[index] = 0;
+        size -= 1;
+        return values[index];
+    }
+
+    // starts a new generation, the stamps are only rewritten
+    // when the counter wraps around
+    void clear()
+    {
+        generation += 1;
+        if (generation == 0)
+        {
+            for (int i = 0; i < W * H; i += 1) stamps[i] = 0;
+            generation = 1;
+        }
+        size = 0;
+    }
+
+    int getSize() {return size;}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef TILE_INDEX_H
+#define TILE_INDEX_H
+
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+
+#include "./arraylist.hpp"
+#include "./chunkdirectory.hpp"
+
+// the cells that were written somewhere, kept by the tile of CHUNK_SIZE
+// squared cells they are in, so the cells of a region are found by
+// looking at its tiles only
+// a cell is listed once however many times it's added, and stays listed
+// until the index is cleared, so the caller checks what's there now
+// K needs x and y members
+template <typename K>
+class TileIndex
+{
+private:
+    struct Tile
+    {
+        // the first cell of the tile
+        int x;
+        int y;
+
+        uint64_t listed[CHUNK_CELLS / 64];
+        ArrayList<K> cells;
+
+        Tile()
+        {
+            for (int i = 0; i < CHUNK_CELLS / 64; i += 1) listed[i] = 0;
+        }
+    };
+
+    typedef ChunkDirectory<Tile> Directory;
+
+    Directory tiles;
+    int size;
+
+public:
+    TileIndex()
+    {
+        size = 0;
+    }
+
+    TileIndex(const TileIndex&) = delete;
+    TileIndex& operator=(const TileIndex&) = delete;
+
+    void add(K k)
+    {
+        Tile* tile = tiles.findOrCreate(k.x, k.y);
+        int index = Directory::indexOf(k.x, k.y);
+        uint64_t bit = 1ULL << (index & 63);
+
+        if (tile->listed[index >> 6] & bit) return;
+        tile->listed[index >> 6] |= bit;
+        tile->cells.push(k);
+        size += 1;
+    }
+
+    // the cells listed in the tile holding x, y, nullptr if there are none
+    ArrayList<K>* cellsAt(int x, int y)
+    {
+        Tile* tile = tiles.find(x, y);
+        return tile == nullptr ? nullptr : &tile->cells;
+    }
+
+    // the tiles stay allocated for the cells added next
+    void clear()
+    {
+        for (int t = 0; t < tiles.getSize(); t += 1)
+        {
+            Tile* tile = tiles.get(t);
+            if (tile->cells.isEmpty()) continue;
+
+            for (int i = 0; i < CHUNK_CELLS / 64; i += 1) tile->listed[i] = 0;
+            tile->cells.clear();
+        }
+        size = 0;
+    }
+
+    int getSize() {return size;}
+
+    int getTilesNumber() {return tiles.getSize();}
+};
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#include "../data_structures/arraylist.hpp"
+#include "../data_structures/bucketqueue.hpp"
+
+#include "./engine.hpp"
+
+// runs many A* queries against the same walls on a pool of threads
+// the walls are copied once into a read-only snapshot that every worker
+// shares, each worker keeps its own open list and tables between queries
+
+struct BatchQuery
+{
+    Vector2I source;
+    Vector2I target;
+};
+
+struct BatchResult
+{
+    bool found;
+    int cost;
+    int length;
+    int expanded;
+};
+
+// the walls of an engine's grid, frozen so many threads can read them
+class GridSnapshot
+{
+private:
+    unsigned char* walls;
+    int width;
+    int height;
+
+public:
+    GridSnapshot()
+    {
+        walls = nullptr;
+        width = 0;
+        height = 0;
+    }
+    ~GridSnapshot()
+    {
+        delete [] walls;
+    }
+
+    GridSnapshot(const GridSnapshot&) = delete;
+    GridSnapshot& operator=(const GridSnapshot&) = delete;
+
+    void freeze(SearchEngine& engine)
+    {
+        if ((long)engine.getWidth() * engine.getHeight() > DENSE_CELLS_LIMIT)
+        {
+            throw std::runtime_error("The map is too big to be copied");
+        }
+        delete [] walls;
+        width = engine.getWidth();
+        height = engine.getHeight();
+        walls = new unsigned char[width * height];
+        for (int i = 0; i < width * height; i += 1) walls[i] = 0;
+
+        BitPlane& wallPlane = engine.getWallPlane();
+        for (int y = 0; y < std::min(height, wallPlane.getHeight()); y += 1)
+        {
+            for (int x = 0; x < std::min(width, wallPlane.getWidth()); x += 1)
+            {
+                walls[y * width + x] = wallPlane.get(x, y);
+            }
+        }
+
+        GridTable::HashIterator iter;
+        iter.begin(engine.getGrid());
+        while (iter.hasNext())
+        {
+            iter.next();
+            Vector2I key = iter.getKey();
+            if (iter.getValue().ct == WALL && key.x < width && key.y < height)
+            {
+                walls[key.y * width + key.x] = 1;
+            }
+        }
+    }
+
+    int getWidth() {return width;}
+    int getHeight() {return height;}
+
+    // FNV-1a over the cells and the size, tells saved tables
+    // built on other walls apart
+    uint64_t hash()
+    {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (int i = 0; i < width * height; i += 1)
+        {
+            h ^= walls[i] + 1;
+            h *= 0x100000001B3ULL;
+        }
+        return h ^ ((uint64_t)width << 32 | height);
+    }
+
+    // cells outside of the snapshot count as walls
+    bool isFree(Vector2I pos)
+    {
+        return pos.x >= 0 && pos.y >= 0 && pos.x < width && pos.y < height &&
+                walls[pos.y * width + pos.x] == 0;
+    }
+};
+
+// dijkstra from source over the snapshot, distTo is -1 for the cells it
+// can't reach, when firstMove is given every reached cell also gets the
+// first move of its shortest path, inherited from the cell it was reached from
+inline void mapDistances(GridSnapshot& grid, BucketQueue<int>& heap, int source, int* distTo,
+        unsigned char* firstMove = nullptr)
+{
+    int width = grid.getWidth();
+    for (int i = 0; i < width * grid.getHeight(); i += 1) distTo[i] = -1;
+    heap.clear();
+    distTo[source] = 0;
+    heap.add(source, 0);
+
+    while (!heap.isEmpty())
+    {
+        int index = heap.removeSmallest();
+        Vector2I pos = Vector2I{.x = index % width, .y = index / width};
+
+        NeighborIterator<GridSnapshot> iter;
+        iter.begin(grid, pos);
+        while (iter.hasNext())
+        {
+            Vector2I newPos = iter.next();
+            int newIndex = newPos.y * width + newPos.x;
+            int newDistance = distTo[index] + iter.getCost();
+
+            if (distTo[newIndex] == -1)
+            {
+                distTo[newIndex] = newDistance;
+                heap.add(newIndex, newDistance);
+            }
+            else if (newDistance < distTo[newIndex] && heap.contains(newIndex))
+            {
+                distTo[newIndex] = newDistance;
+                heap.decreaseKey(newIndex, newDistance);
+            }
+            else continue;
+
+            if (firstMove != nullptr) firstMove[newIndex] = index == source ? iter.getMove() : firstMove[index];
+        }
+    }
+}
+
+class BatchEngine
+{
+private:
+    // the search state of one thread, cleared by bumping the generations
+    class Worker
+    {
+    private:
+        OpenList heap;
+        SearchTable<Vector2I, int> distTo;
+        SearchTable<Vector2I, Vector2I> from;
+
+        OpenKey priority(Vector2I vertex, Vector2I target)
+        {
+            float dx = vertex.x - target.x;
+            float dy = vertex.y - target.y;
+            return distTo.get(vertex) + sqrt(dx * dx + dy * dy);
+        }
+
+    public:
+        BatchResult search(GridSnapshot& grid, BatchQuery& query)
+        {
+            BatchResult result;
+            result.found = false;
+            result.cost = -1;
+            result.length = -1;
+            result.expanded = 0;
+
+            if (!grid.isFree(query.source) || !grid.isFree(query.target)) return result;
+
+            heap.clear();
+            distTo.clear();
+            from.clear();
+
+            distTo.insert(query.source, 0);
+            from.insert(query.source, query.source);
+            heap.add(query.source, priority(query.source, query.target));
+
+            while (!heap.isEmpty())
+            {
+                Vector2I pos = heap.removeSmallest();
+                result.expanded += 1;
+
+                if (pos == query.target)
+                {
+                    result.found = true;
+                    result.cost = distTo.get(pos);
+                    result.length = 0;
+                    for (; pos != query.source; pos = from.get(pos)) result.length += 1;
+                    return result;
+                }
+
+                int distance = distTo.get(pos);
+                NeighborIterator<GridSnapshot> iter;
+                iter.begin(grid, pos);
+                while (iter.hasNext())
+                {
+                    Vector2I newPos = iter.next();
+                    int newDistance = distance + iter.getCost();
+                    int* oldDistance = distTo.find(newPos);
+
+                    if (oldDistance == nullptr)
+                    {
+                        distTo.insert(newPos, newDistance);
+                        from.insert(newPos, pos);
+                        heap.add(newPos, priority(newPos, query.target));
+                    }
+                    else if (newDistance < *oldDistance && heap.contains(newPos))
+                    {
+                        *oldDistance = newDistance;
+                        from.insert(newPos, pos);
+                        heap.decreaseKey(newPos, priority(newPos, query.target));
+                    }
+                }
+            }
+            return result;
+        }
+    };
+
+    // the queries handed to one worker, other workers steal from the
+    // front of it once their own range runs out
+    struct alignas(64) Range
+    {
+        std::atomic<int> next;
+        int end;
+    };
+
+    GridSnapshot snapshot;
+
+    int threadsNumber;
+    std::thread* threads;
+    Worker** workers;
+    Range* ranges;
+
+    // the batch being run, workers sleep until batch changes
+    BatchQuery* queries;
+    BatchResult* results;
+    int batch;
+    int idleWorkers;
+    bool quitting;
+    // the first error a query of the batch ran into, empty if none did
+    std::string error;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // the last batch
+    int lastQueries;
+    double lastSeconds;
+
+    // takes the next query of the worker's own range or steals one
+    // returns -1 once every range is empty
+    int takeQuery(int worker)
+    {
+        for (int i = 0; i < threadsNumber; i += 1)
+        {
+            Range& range = ranges[(worker + i) % threadsNumber];
+            if (range.next >= range.end) continue;
+
+            int query = range.next.fetch_add(1);
+            if (query < range.end) return query;
+        }
+        return -1;
+    }
+
+    void work(int worker)
+    {
+        workers[worker] = new Worker();
+        int seenBatch = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                idleWorkers += 1;
+                if (idleWorkers == threadsNumber) done.notify_one();
+
+                wake.wait(guard, [&]() {return quitting || batch != seenBatch;});
+                if (quitting) return;
+                seenBatch = batch;
+            }
+
+            // an error goes back to the thread running the batch, the
+            // other queries still run
+            for (int query = takeQuery(worker); query != -1; query = takeQuery(worker))
+            {
+                try
+                {
+                    results[query] = workers[worker]->search(snapshot, queries[query]);
+                }
+                catch (std::runtime_error& e)
+                {
+                    results[query] = BatchResult{.found = false, .cost = -1, .length = -1, .expanded = 0};
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (error.empty()) error = e.what();
+                }
+            }
+        }
+    }
+
+public:
+    // zero threads means one per core
+    BatchEngine(int threadsCount = 0)
+    {
+        threadsNumber = threadsCount > 0 ? threadsCount : std::thread::hardware_concurrency();
+        if (threadsNumber <= 0) threadsNumber = 1;
+
+        workers = new Worker*[threadsNumber];
+        ranges = new Range[threadsNumber];
+        threads = new std::thread[threadsNumber];
+
+        queries = nullptr;
+        results = nullptr;
+        batch = 0;
+        idleWorkers = 0;
+        quitting = false;
+        lastQueries = 0;
+        lastSeconds = 0;
+
+        for (int i = 0; i < threadsNumber; i += 1)
+        {
+            ranges[i].next = 0;
+            ranges[i].end = 0;
+            threads[i] = std::thread(&BatchEngine::work, this, i);
+        }
+    }
+    ~BatchEngine()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quitting = true;
+        }
+        wake.notify_all();
+        for (int i = 0; i < threadsNumber; i += 1)
+        {
+            threads[i].join();
+            delete workers[i];
+        }
+        delete [] threads;
+        delete [] workers;
+        delete [] ranges;
+    }
+
+    BatchEngine(const BatchEngine&) = delete;
+    BatchEngine& operator=(const BatchEngine&) = delete;
+
+    // copies the walls of the engine, the queries run against this copy
+    // until the next freeze
+    void freeze(SearchEngine& engine)
+    {
+        // the tables of the workers can't hold the cells of a larger map
+        if (engine.getWidth() > SEARCH_TABLE_CELLS || engine.getHeight() > SEARCH_TABLE_CELLS)
+        {
+            throw std::runtime_error("The map is too big for the batch");
+        }
+        snapshot.freeze(engine);
+    }
+
+    // runs every query and puts its result at the same index of results,
+    // throws the first error a query ran into once all of them are done
+    void run(ArrayList<BatchQuery>& queryList, ArrayList<BatchResult>& resultList)
+    {
+        int size = queryList.getSize();
+        BatchQuery* batchQueries = new BatchQuery[size];
+        BatchResult* batchResults = new BatchResult[size];
+        for (int i = 0; i < size; i += 1) batchQueries[i] = queryList.get(i);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [&]() {return idleWorkers == threadsNumber;});
+
+            queries = batchQueries;
+            results = batchResults;
+            for (int i = 0; i < threadsNumber; i += 1)
+            {
+                ranges[i].next = (long)size * i / threadsNumber;
+                ranges[i].end = (long)size * (i + 1) / threadsNumber;
+            }
+            idleWorkers = 0;
+            error.clear();
+            batch += 1;
+        }
+        wake.notify_all();
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [&]() {return idleWorkers == threadsNumber;});
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        lastQueries = size;
+        lastSeconds = std::chrono::duration<double>(end - start).count();
+
+        resultList.clear();
+        for (int i = 0; i < size; i += 1) resultList.push(batchResults[i]);
+
+        delete [] batchQueries;
+        delete [] batchResults;
+
+        if (!error.empty()) throw std::runtime_error(error);
+    }
+
+    int getThreadsNumber() {return threadsNumber;}
+
+    double getSeconds() {return lastSeconds;}
+
+    double getQueriesPerSecond()
+    {
+        return lastSeconds > 0 ? lastQueries / lastSeconds : 0;
+    }
+};
+
+#endif
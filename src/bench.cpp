@@ -0,0 +1,283 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "./batch.hpp"
+#include "./engine.hpp"
+#include "./landmarks.hpp"
+#include "./maps.hpp"
+#include "./pathcache.hpp"
+
+// runs every query of a MovingAI scenario through every searcher,
+// then through the batch engine with more and more threads, and twice
+// through the path cache
+//
+// usage: bench <map file> <scenario file> [--csv <file> | --json <file>]
+// the results are written as csv to the standard output by default
+
+#define ALGORITHMS_NUMBER 8
+
+static const char* algorithmNames[] = {"dijkstra", "astar", "bfs", "jps", "bidirectional", "lpastar", "hpastar", "alt"};
+
+struct Result
+{
+    int algorithm;
+    int scenario;
+    bool found;
+    int cost;
+    int length;
+    int expanded;
+    int pushes;
+    int pops;
+    double seconds;
+};
+
+SearchEngine* createEngine(int algorithm)
+{
+    if (algorithm == 0) return new DijkstraEngine();
+    if (algorithm == 1) return new AStarEngine();
+    if (algorithm == 2) return new BFSEngine();
+    if (algorithm == 3) return new JPSEngine();
+    if (algorithm == 4) return new BidirectionalEngine();
+    if (algorithm == 5) return new LPAStarEngine();
+    if (algorithm == 6) return new HPAStarEngine();
+    return new ALTEngine();
+}
+
+// the highest resident memory of the process in kilobytes
+long peakMemory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+double nodesPerSecond(double nodes, double seconds)
+{
+    return seconds > 0 ? nodes / seconds : 0;
+}
+
+void writeCsv(std::ostream& out, ArrayList<Result>& results, ArrayList<Scenario>& scenarios)
+{
+    out << "algorithm,scenario,sx,sy,tx,ty,optimal,found,cost,length,expanded,pushes,pops,microseconds,nodes_per_second" << std::endl;
+    for (int i = 0; i < results.getSize(); i += 1)
+    {
+        Result& r = results.get(i);
+        Scenario& s = scenarios.get(r.scenario);
+        out << algorithmNames[r.algorithm] << "," << r.scenario << ","
+            << s.source.x << "," << s.source.y << "," << s.target.x << "," << s.target.y << ","
+            << s.optimalLength << "," << r.found << "," << r.cost << "," << r.length << ","
+            << r.expanded << "," << r.pushes << "," << r.pops << ","
+            << r.seconds * 1e6 << "," << nodesPerSecond(r.expanded, r.seconds) << std::endl;
+    }
+}
+
+void writeJson(std::ostream& out, ArrayList<Result>& results, ArrayList<Scenario>& scenarios)
+{
+    out << "{\"peak_memory_kb\": " << peakMemory() << ", \"results\": [" << std::endl;
+    for (int i = 0; i < results.getSize(); i += 1)
+    {
+        Result& r = results.get(i);
+        Scenario& s = scenarios.get(r.scenario);
+        out << "  {\"algorithm\": \"" << algorithmNames[r.algorithm] << "\", \"scenario\": " << r.scenario
+            << ", \"source\": [" << s.source.x << ", " << s.source.y << "]"
+            << ", \"target\": [" << s.target.x << ", " << s.target.y << "]"
+            << ", \"optimal\": " << s.optimalLength << ", \"found\": " << (r.found ? "true" : "false")
+            << ", \"cost\": " << r.cost << ", \"length\": " << r.length
+            << ", \"expanded\": " << r.expanded << ", \"pushes\": " << r.pushes << ", \"pops\": " << r.pops
+            << ", \"microseconds\": " << r.seconds * 1e6
+            << ", \"nodes_per_second\": " << nodesPerSecond(r.expanded, r.seconds) << "}"
+            << (i + 1 < results.getSize() ? "," : "") << std::endl;
+    }
+    out << "]}" << std::endl;
+}
+
+// prints the totals of every searcher
+void writeSummary(std::ostream& out, ArrayList<Result>& results)
+{
+    for (int a = 0; a < ALGORITHMS_NUMBER; a += 1)
+    {
+        long expanded = 0;
+        long pushes = 0;
+        double seconds = 0;
+        int queries = 0;
+        for (int i = 0; i < results.getSize(); i += 1)
+        {
+            Result& r = results.get(i);
+            if (r.algorithm != a) continue;
+            expanded += r.expanded;
+            pushes += r.pushes;
+            seconds += r.seconds;
+            queries += 1;
+        }
+        out << algorithmNames[a] << ": " << queries << " queries, " << expanded << " expanded, "
+            << pushes << " pushes, " << seconds * 1e3 << " ms, "
+            << nodesPerSecond(expanded, seconds) << " nodes/s" << std::endl;
+    }
+    out << "peak memory: " << peakMemory() << " KB" << std::endl;
+}
+
+// runs all the scenarios as one batch on 1, 2, 4, ... threads up to one
+// per core, the costs are checked against the single threaded A*
+void writeBatchSummary(std::ostream& out, SearchEngine& engine, ArrayList<Scenario>& scenarios, ArrayList<Result>& results)
+{
+    ArrayList<BatchQuery> queries;
+    for (int i = 0; i < scenarios.getSize(); i += 1)
+    {
+        BatchQuery query = BatchQuery{.source = scenarios.get(i).source, .target = scenarios.get(i).target};
+        queries.push(query);
+    }
+
+    int cores = std::thread::hardware_concurrency();
+    double singleRate = 0;
+    for (int threads = 1; ; threads *= 2)
+    {
+        if (threads > cores) threads = cores;
+
+        BatchEngine batch(threads);
+        batch.freeze(engine);
+        ArrayList<BatchResult> batchResults;
+        batch.run(queries, batchResults);
+
+        int mismatches = 0;
+        for (int i = 0; i < results.getSize(); i += 1)
+        {
+            Result& r = results.get(i);
+            if (algorithmNames[r.algorithm] == std::string("astar") && batchResults.get(r.scenario).cost != r.cost)
+            {
+                mismatches += 1;
+            }
+        }
+
+        if (threads == 1) singleRate = batch.getQueriesPerSecond();
+        out << "batch " << threads << " threads: " << batch.getQueriesPerSecond() << " queries/s, "
+            << (singleRate > 0 ? batch.getQueriesPerSecond() / singleRate : 0) << "x, "
+            << mismatches << " cost mismatches" << std::endl;
+
+        if (threads >= cores) break;
+    }
+}
+
+// runs all the scenarios twice through A* and a path cache big enough
+// for all of them, the second time every query should be a hit
+void writeCacheSummary(std::ostream& out, SearchEngine& engine, ArrayList<Scenario>& scenarios)
+{
+    PathCache cache(std::max(scenarios.getSize(), PATH_CACHE_SIZE));
+    for (int pass = 1; pass <= 2; pass += 1)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < scenarios.getSize(); i += 1)
+        {
+            Scenario& s = scenarios.get(i);
+            if (!engine.setEndpoints(s.source, s.target)) continue;
+
+            if (!cache.lookup(engine))
+            {
+                engine.run();
+                engine.solve();
+                cache.store(engine);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        out << "cache pass " << pass << ": " << std::chrono::duration<double>(end - start).count() * 1e3 << " ms, "
+            << cache.getHits() << " hits, " << cache.getMisses() << " misses" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <map file> <scenario file> [--csv <file> | --json <file>]" << std::endl;
+        return 1;
+    }
+
+    ArrayList<Scenario> scenarios;
+    if (!loadScenarios(argv[2], scenarios))
+    {
+        std::cerr << "can not read the scenarios " << argv[2] << std::endl;
+        return 1;
+    }
+
+    ArrayList<Result> results;
+
+    try
+    {
+        for (int a = 0; a < ALGORITHMS_NUMBER; a += 1)
+        {
+            SearchEngine* engine = createEngine(a);
+            if (!loadMap(*engine, argv[1]))
+            {
+                std::cerr << "can not read the map " << argv[1] << std::endl;
+                delete engine;
+                return 1;
+            }
+
+            for (int i = 0; i < scenarios.getSize(); i += 1)
+            {
+                Scenario& s = scenarios.get(i);
+                if (!engine->setEndpoints(s.source, s.target)) continue;
+
+                auto start = std::chrono::steady_clock::now();
+                engine->run();
+                engine->solve();
+                auto end = std::chrono::steady_clock::now();
+
+                Result r;
+                r.algorithm = a;
+                r.scenario = i;
+                r.found = engine->isPathFound();
+                r.cost = engine->getPathCost();
+                r.length = engine->getPathLength();
+                r.expanded = engine->getExpanded();
+                r.pushes = engine->getPushes();
+                r.pops = engine->getPops();
+                r.seconds = std::chrono::duration<double>(end - start).count();
+                results.push(r);
+            }
+            delete engine;
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (argc >= 5 && strcmp(argv[3], "--json") == 0)
+    {
+        std::ofstream out(argv[4]);
+        writeJson(out, results, scenarios);
+    }
+    else if (argc >= 5 && strcmp(argv[3], "--csv") == 0)
+    {
+        std::ofstream out(argv[4]);
+        writeCsv(out, results, scenarios);
+    }
+    else
+    {
+        writeCsv(std::cout, results, scenarios);
+    }
+
+    writeSummary(std::cerr, results);
+
+    DijkstraEngine engine;
+    try
+    {
+        if (loadMap(engine, argv[1])) writeBatchSummary(std::cerr, engine, scenarios, results);
+    }
+    catch (std::runtime_error& e)
+    {
+        std::cerr << "batch: " << e.what() << std::endl;
+    }
+
+    AStarEngine cachedEngine;
+    if (loadMap(cachedEngine, argv[1]))
+    {
+        writeCacheSummary(std::cerr, cachedEngine, scenarios);
+    }
+    return 0;
+}
\ No newline at end of file
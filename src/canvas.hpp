@@ -0,0 +1,378 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/raylib/src/raylib.h"
+#include "../data_structures/arraylist.hpp"
+
+#include "./searchers.hpp"
+
+// the settled cells are kept in a texture with one texel for every cell,
+// every frame only the cells the engine changed are written to it and the
+// whole texture is drawn once, scaled to the view
+// the cells that are still growing or moving are drawn on their own
+//
+// the texture is split in tiles of CHUNK_SIZE squared texels, when the engine
+// can't tell what changed every tile goes out of date and only the tiles in
+// view are written again, from the cells the engine's tile index has in them
+//
+// a canvas with a scale above 1 has a texel for every block of BLOCK_SIZE
+// squared cells instead, for views where the cells are smaller than a pixel,
+// a block is drawn from the engine's block counts without its cells
+
+// the largest side of the texture, a larger map gets the part around the view
+#define CANVAS_CELLS 2048
+#define CANVAS_TILES (CANVAS_CELLS / CHUNK_SIZE)
+#define CANVAS_COLOR LIGHTGRAY
+
+// the walls of a block are counted from the mapped plane by its tiles
+static_assert(BLOCK_SIZE == TILE_SIZE, "a block has to be a tile of the wall plane");
+
+class GridCanvas
+{
+private:
+    Texture2D texture;
+    bool loaded;
+
+    // a texel covers 1 << scaleBits cells on each side
+    int scaleBits;
+
+    // the texels, a copy is kept so changed rows can be sent as they are
+    Color* pixels;
+
+    // the texels covered by the texture, in texels of the whole map
+    Vector2I origin;
+    int width;
+    int height;
+
+    // the rows written since the texture was last sent
+    int firstDirtyRow;
+    int lastDirtyRow;
+
+    // the tiles of the texture that show the cells as they are
+    bool upToDate[CANVAS_TILES * CANVAS_TILES];
+
+    // the cells drawn on their own until their animation is over
+    ArrayList<Vector2I> animating;
+    ArrayList<Vector2I> stillAnimating;
+
+    bool covers(Vector2I pos)
+    {
+        return pos.x >= origin.x && pos.y >= origin.y &&
+                pos.x < origin.x + width && pos.y < origin.y + height;
+    }
+
+    Vector2I texelOf(Vector2I pos)
+    {
+        return Vector2I{.x = pos.x >> scaleBits, .y = pos.y >> scaleBits};
+    }
+
+    // the tile of the texture holding the texel, the texel has to be covered
+    int tileOf(Vector2I pos)
+    {
+        return ((pos.y - origin.y) / CHUNK_SIZE) * CANVAS_TILES + (pos.x - origin.x) / CHUNK_SIZE;
+    }
+
+    void outdateTiles()
+    {
+        for (int i = 0; i < CANVAS_TILES * CANVAS_TILES; i += 1) upToDate[i] = false;
+        animating.clear();
+    }
+
+    void paint(Vector2I pos, Color color)
+    {
+        int row = pos.y - origin.y;
+        pixels[row * width + pos.x - origin.x] = color;
+        firstDirtyRow = std::min(firstDirtyRow, row);
+        lastDirtyRow = std::max(lastDirtyRow, row);
+    }
+
+    static Color mixColors(Color from, Color to, float amount)
+    {
+        return Color{
+            .r = (unsigned char)(from.r + (to.r - from.r) * amount),
+            .g = (unsigned char)(from.g + (to.g - from.g) * amount),
+            .b = (unsigned char)(from.b + (to.b - from.b) * amount),
+            .a = (unsigned char)(from.a + (to.a - from.a) * amount)
+        };
+    }
+
+    // a block with a path shows the path, any other block is the empty color
+    // turned toward the checked color by the part of its open cells that
+    // were checked and toward the wall color by the part that are walls
+    void paintBlock(SearchEngine& engine, Vector2I texel)
+    {
+        BlockCounts<Vector2I>& counts = engine.getBlockCounts();
+        int x = texel.x << scaleBits;
+        int y = texel.y << scaleBits;
+
+        if (counts.countAt(x, y, PATH) > 0)
+        {
+            paint(texel, COLORS[PATH]);
+            return;
+        }
+
+        float cells = BLOCK_SIZE * BLOCK_SIZE;
+        float walls = counts.countAt(x, y, WALL) + engine.getWallPlane().countTile(x, y);
+        float checked = counts.countAt(x, y, CHECKED);
+
+        Color color = walls < cells ? mixColors(CANVAS_COLOR, COLORS[CHECKED], checked / (cells - walls)) : CANVAS_COLOR;
+        paint(texel, mixColors(color, COLORS[WALL], walls / cells));
+    }
+
+    // writes the settled look of the cell, a cell still animating is left
+    // empty and drawn on its own until it settles
+    void paintCell(Searcher& searcher, Vector2I pos)
+    {
+        if (scaleBits > 0)
+        {
+            paintBlock(searcher.getEngine(), texelOf(pos));
+            return;
+        }
+
+        Cell cell;
+        if (!searcher.findCell(pos, &cell)) paint(pos, CANVAS_COLOR);
+        else if (searcher.isAnimating(&cell))
+        {
+            paint(pos, CANVAS_COLOR);
+            // the source and the target are drawn every frame anyway
+            if (cell.ct != SOURCE && cell.ct != TARGET) animating.push(pos);
+        }
+        else paint(pos, COLORS[cell.ct]);
+    }
+
+    // moves the texture over the view, returns true if it covers other cells now
+    bool fit(Searcher& searcher)
+    {
+        SearchEngine& engine = searcher.getEngine();
+        int mapWidth = (engine.getWidth() + (1 << scaleBits) - 1) >> scaleBits;
+        int mapHeight = (engine.getHeight() + (1 << scaleBits) - 1) >> scaleBits;
+        int newWidth = std::min(mapWidth, CANVAS_CELLS);
+        int newHeight = std::min(mapHeight, CANVAS_CELLS);
+
+        Vector2I first;
+        Vector2I last;
+        searcher.getVisibleCells(&first, &last);
+        first = texelOf(first);
+        last = texelOf(last);
+
+        Vector2I newOrigin = origin;
+        if (!covers(first) || !covers(Vector2I{.x = std::min(last.x, mapWidth - 1), .y = std::min(last.y, mapHeight - 1)}))
+        {
+            // the view in the middle of the texture, the tiles of the texture
+            // are the tiles of the grid so the texture may go past the map
+            newOrigin.x = std::max(0, first.x - (newWidth - (last.x - first.x)) / 2) / CHUNK_SIZE * CHUNK_SIZE;
+            newOrigin.y = std::max(0, first.y - (newHeight - (last.y - first.y)) / 2) / CHUNK_SIZE * CHUNK_SIZE;
+        }
+
+        if (loaded && newWidth == width && newHeight == height && newOrigin.x == origin.x && newOrigin.y == origin.y)
+        {
+            return false;
+        }
+
+        if (!loaded || newWidth != width || newHeight != height)
+        {
+            unload();
+            delete [] pixels;
+            width = newWidth;
+            height = newHeight;
+            pixels = new Color[width * height];
+            for (int i = 0; i < width * height; i += 1) pixels[i] = CANVAS_COLOR;
+
+            Image image = {.data = pixels, .width = width, .height = height, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            texture = LoadTextureFromImage(image);
+            loaded = true;
+        }
+        origin = newOrigin;
+        return true;
+    }
+
+    // writes every texel of the tile from x, y again
+    void redrawTile(Searcher& searcher, int x, int y)
+    {
+        SearchEngine& engine = searcher.getEngine();
+        int lastX = std::min(x + CHUNK_SIZE, origin.x + width);
+        int lastY = std::min(y + CHUNK_SIZE, origin.y + height);
+
+        if (scaleBits > 0)
+        {
+            for (int row = y; row < lastY; row += 1)
+            {
+                for (int column = x; column < lastX; column += 1) paintBlock(engine, Vector2I{.x = column, .y = row});
+            }
+            upToDate[tileOf(Vector2I{.x = x, .y = y})] = true;
+            return;
+        }
+
+        for (int row = y; row < lastY; row += 1)
+        {
+            for (int column = x; column < lastX; column += 1) paint(Vector2I{.x = column, .y = row}, CANVAS_COLOR);
+        }
+
+        ArrayList<Vector2I>* cells = engine.getTouchedTiles().cellsAt(x, y);
+        for (int i = 0; cells != nullptr && i < cells->getSize(); i += 1)
+        {
+            if (covers(cells->get(i))) paintCell(searcher, cells->get(i));
+        }
+
+        BitPlane& walls = engine.getWallPlane();
+        for (int row = y; row < std::min(lastY, walls.getHeight()); row += 1)
+        {
+            for (int column = x; column < std::min(lastX, walls.getWidth()); column += 1)
+            {
+                if (walls.get(column, row)) paint(Vector2I{.x = column, .y = row}, COLORS[WALL]);
+            }
+        }
+
+        upToDate[tileOf(Vector2I{.x = x, .y = y})] = true;
+    }
+
+    // writes again the tiles in view that went out of date
+    void redrawVisible(Searcher& searcher)
+    {
+        Vector2I first;
+        Vector2I last;
+        searcher.getVisibleCells(&first, &last);
+        first = texelOf(first);
+        last = texelOf(last);
+
+        int firstX = std::max(first.x, origin.x) / CHUNK_SIZE * CHUNK_SIZE;
+        int firstY = std::max(first.y, origin.y) / CHUNK_SIZE * CHUNK_SIZE;
+        int lastX = std::min(last.x, origin.x + width - 1);
+        int lastY = std::min(last.y, origin.y + height - 1);
+
+        for (int y = firstY; y <= lastY; y += CHUNK_SIZE)
+        {
+            for (int x = firstX; x <= lastX; x += CHUNK_SIZE)
+            {
+                if (!upToDate[tileOf(Vector2I{.x = x, .y = y})]) redrawTile(searcher, x, y);
+            }
+        }
+    }
+
+    void drawAnimating(Searcher& searcher, Vector2I pos)
+    {
+        Cell cell;
+        Rectangle rect;
+        if (!searcher.findCell(pos, &cell) || !searcher.isValidRect(pos)) return;
+
+        searcher.generateRect(pos, &rect, &cell);
+        DrawRectangle(rect.x, rect.y, rect.width, rect.height, COLORS[cell.ct]);
+    }
+
+    // the source and the target take their whole block when the cells are too small to see
+    void drawBlockOf(Searcher& searcher, Vector2I pos)
+    {
+        Cell cell;
+        if (!searcher.findCell(pos, &cell)) return;
+
+        Vector2I texel = texelOf(pos);
+        Rectangle rect = searcher.getCellsRect(texel.x << scaleBits, texel.y << scaleBits, 1 << scaleBits, 1 << scaleBits);
+        DrawRectangleRec(rect, COLORS[cell.ct]);
+    }
+
+public:
+    // scaleBits is 0 for a texel per cell, BLOCK_BITS for a texel per block
+    GridCanvas(int scaleBits)
+    {
+        if (scaleBits != 0 && scaleBits != BLOCK_BITS)
+        {
+            throw std::runtime_error("A canvas texel is a cell or a block");
+        }
+        this->scaleBits = scaleBits;
+        loaded = false;
+        pixels = nullptr;
+        origin = Vector2I{.x = 0, .y = 0};
+        width = 0;
+        height = 0;
+        firstDirtyRow = 0;
+        lastDirtyRow = -1;
+        for (int i = 0; i < CANVAS_TILES * CANVAS_TILES; i += 1) upToDate[i] = false;
+    }
+    ~GridCanvas()
+    {
+        delete [] pixels;
+    }
+
+    GridCanvas(const GridCanvas&) = delete;
+    GridCanvas& operator=(const GridCanvas&) = delete;
+
+    // the texture has to go before the window does
+    void unload()
+    {
+        if (loaded) UnloadTexture(texture);
+        loaded = false;
+    }
+
+    // the texture is written again the next time it's drawn, for a canvas
+    // that wasn't drawn while the cells changed
+    void outdate()
+    {
+        outdateTiles();
+    }
+
+    void draw(Searcher& searcher)
+    {
+        SearchEngine& engine = searcher.getEngine();
+
+        if (fit(searcher) || engine.hasEverythingChanged()) outdateTiles();
+        else
+        {
+            // a tile out of date is written whole once it's in view
+            ArrayList<Vector2I>& changed = engine.getChangedCells();
+            for (int i = 0; i < changed.getSize(); i += 1)
+            {
+                Vector2I pos = changed.get(i);
+                Vector2I texel = texelOf(pos);
+                if (covers(texel) && upToDate[tileOf(texel)]) paintCell(searcher, pos);
+            }
+        }
+        engine.forgetChanges();
+        redrawVisible(searcher);
+
+        // the cells done animating go to the texture
+        stillAnimating.clear();
+        for (int i = 0; i < animating.getSize(); i += 1)
+        {
+            Vector2I pos = animating.get(i);
+            Cell cell;
+            if (searcher.findCell(pos, &cell) && searcher.isAnimating(&cell)) stillAnimating.push(pos);
+            else paintCell(searcher, pos);
+        }
+        animating.clear();
+        for (int i = 0; i < stillAnimating.getSize(); i += 1) animating.push(stillAnimating.get(i));
+
+        if (firstDirtyRow <= lastDirtyRow)
+        {
+            Rectangle rows = {.x = 0, .y = (float)firstDirtyRow, .width = (float)width, .height = (float)(lastDirtyRow - firstDirtyRow + 1)};
+            UpdateTextureRec(texture, rows, &pixels[firstDirtyRow * width]);
+            firstDirtyRow = height;
+            lastDirtyRow = -1;
+        }
+
+        Rectangle area = searcher.getGridArea();
+        BeginScissorMode(area.x, area.y, area.width, area.height);
+
+        Rectangle source = {.x = 0, .y = 0, .width = (float)width, .height = (float)height};
+        Rectangle dest = searcher.getCellsRect(origin.x << scaleBits, origin.y << scaleBits, width << scaleBits, height << scaleBits);
+        DrawTexturePro(texture, source, dest, Vector2{.x = 0, .y = 0}, 0, WHITE);
+
+        if (scaleBits > 0)
+        {
+            drawBlockOf(searcher, engine.getSourcePos());
+            drawBlockOf(searcher, engine.getTargetPos());
+        }
+        else
+        {
+            for (int i = 0; i < animating.getSize(); i += 1) drawAnimating(searcher, animating.get(i));
+            drawAnimating(searcher, engine.getSourcePos());
+            drawAnimating(searcher, engine.getTargetPos());
+        }
+
+        EndScissorMode();
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string.h>
+
+#include "./cpd.hpp"
+#include "./engine.hpp"
+#include "./goalbounds.hpp"
+#include "./landmarks.hpp"
+#include "./maps.hpp"
+#include "./pathcache.hpp"
+
+// runs searches on a map without a window
+//
+// usage: cli <map file> [dijkstra | astar | bfs | jps | bidirectional | lpastar | hpastar | alt | cpd | goalbounds] [sx sy tx ty]
+//        cli <map file> save <saved map>
+// without a query on the command line, one "sx sy tx ty" query is read
+// from every line of the standard input
+// every query prints: algorithm sx sy tx ty cost length expanded
+// cpd keeps its path database next to the map as <map file>.cpd, it's
+// built and saved the first time and loaded while the walls match,
+// goalbounds does the same with its boxes in <map file>.gb
+// a query asked again is answered from the path cache, its hits and
+// misses are printed to the standard error at the end
+// save writes the walls of the map in the binary format, a saved map
+// is mapped from the file instead of read so large maps open at once
+
+SearchEngine* createEngine(const char* algorithm)
+{
+    if (strcmp(algorithm, "dijkstra") == 0) return new DijkstraEngine();
+    if (strcmp(algorithm, "astar") == 0) return new AStarEngine();
+    if (strcmp(algorithm, "bfs") == 0) return new BFSEngine();
+    if (strcmp(algorithm, "jps") == 0) return new JPSEngine();
+    if (strcmp(algorithm, "bidirectional") == 0) return new BidirectionalEngine();
+    if (strcmp(algorithm, "lpastar") == 0) return new LPAStarEngine();
+    if (strcmp(algorithm, "hpastar") == 0) return new HPAStarEngine();
+    if (strcmp(algorithm, "alt") == 0) return new ALTEngine();
+    if (strcmp(algorithm, "cpd") == 0) return new CPDEngine();
+    if (strcmp(algorithm, "goalbounds") == 0) return new GoalBoundingEngine();
+    return nullptr;
+}
+
+void runQuery(SearchEngine* engine, PathCache& cache, const char* algorithm, Vector2I source, Vector2I target)
+{
+    std::cout << algorithm << " " << source.x << " " << source.y << " " << target.x << " " << target.y << " ";
+
+    if (!engine->setEndpoints(source, target))
+    {
+        std::cout << "invalid" << std::endl;
+        return;
+    }
+
+    if (!cache.lookup(*engine))
+    {
+        engine->run();
+        engine->solve();
+        cache.store(*engine);
+    }
+
+    if (engine->isPathFound())
+    {
+        std::cout << engine->getPathCost() << " " << engine->getPathLength() << " " << engine->getExpanded() << std::endl;
+    }
+    else
+    {
+        std::cout << "no-path - " << engine->getExpanded() << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <map file> [dijkstra | astar | bfs | jps | bidirectional | lpastar | hpastar | alt | cpd | goalbounds] [sx sy tx ty]" << std::endl;
+        std::cerr << "       " << argv[0] << " <map file> save <saved map>" << std::endl;
+        return 1;
+    }
+
+    if (argc > 3 && strcmp(argv[2], "save") == 0)
+    {
+        DijkstraEngine engine;
+        try
+        {
+            if (!loadMap(engine, argv[1]))
+            {
+                std::cerr << "can not read the map " << argv[1] << std::endl;
+                return 1;
+            }
+        }
+        catch (std::runtime_error& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        if (!engine.saveWalls(argv[3]))
+        {
+            std::cerr << "can not write the map " << argv[3] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    const char* algorithm = argc > 2 ? argv[2] : "astar";
+    SearchEngine* engine = createEngine(algorithm);
+    if (engine == nullptr)
+    {
+        std::cerr << "unknown algorithm " << algorithm << std::endl;
+        return 1;
+    }
+
+    PathCache cache;
+
+    try
+    {
+        if (!loadMap(*engine, argv[1]))
+        {
+            std::cerr << "can not read the map " << argv[1] << std::endl;
+            delete engine;
+            return 1;
+        }
+
+        CPDEngine* cpd = dynamic_cast<CPDEngine*>(engine);
+        if (cpd != nullptr)
+        {
+            std::string database = std::string(argv[1]) + ".cpd";
+            if (!cpd->loadDatabase(database.c_str()))
+            {
+                cpd->buildDatabase();
+                if (!cpd->saveDatabase(database.c_str()))
+                {
+                    std::cerr << "can not write the path database " << database << std::endl;
+                }
+            }
+        }
+
+        GoalBoundingEngine* goalBounding = dynamic_cast<GoalBoundingEngine*>(engine);
+        if (goalBounding != nullptr)
+        {
+            std::string bounds = std::string(argv[1]) + ".gb";
+            if (!goalBounding->loadBounds(bounds.c_str()))
+            {
+                goalBounding->buildBounds();
+                if (!goalBounding->saveBounds(bounds.c_str()))
+                {
+                    std::cerr << "can not write the goal bounds " << bounds << std::endl;
+                }
+            }
+        }
+
+        if (argc >= 7)
+        {
+            Vector2I source = Vector2I{.x = atoi(argv[3]), .y = atoi(argv[4])};
+            Vector2I target = Vector2I{.x = atoi(argv[5]), .y = atoi(argv[6])};
+            runQuery(engine, cache, algorithm, source, target);
+        }
+        else
+        {
+            std::string line;
+            while (std::getline(std::cin, line))
+            {
+                std::istringstream query(line);
+                Vector2I source;
+                Vector2I target;
+                if (query >> source.x >> source.y >> target.x >> target.y)
+                {
+                    runQuery(engine, cache, algorithm, source, target);
+                }
+            }
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        delete engine;
+        return 1;
+    }
+
+    std::cerr << "cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses" << std::endl;
+
+    delete engine;
+    return 0;
+}
\ No newline at end of file
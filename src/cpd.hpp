@@ -0,0 +1,361 @@
+#ifndef CPD_H
+#define CPD_H
+
+#include <atomic>
+#include <fstream>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+#include "../data_structures/arraylist.hpp"
+#include "../data_structures/bucketqueue.hpp"
+
+#include "./batch.hpp"
+#include "./engine.hpp"
+
+// a compressed path database, for every source cell it keeps the first
+// move of a shortest path toward every target, the moves of one source
+// are run-length compressed over the targets in row-major order
+// building it runs one dijkstra per free cell, so it's done offline and
+// saved, a query then follows first moves without any search
+
+// NO_MOVE marks the targets that can't be reached
+#define NO_MOVE 8
+
+// a run is the first target it covers shifted over its move
+#define MOVE_BITS 4
+
+class PathDatabase
+{
+private:
+    int width;
+    int height;
+
+    // the runs of source i are runs[offsets[i]] to runs[offsets[i + 1] - 1]
+    uint32_t* offsets;
+    uint32_t* runs;
+    uint32_t runsNumber;
+
+    // the walls the database was built on
+    uint64_t wallsHash;
+
+    // the sources are handed out one at a time to the building threads
+    std::atomic<int> nextSource;
+
+    void release()
+    {
+        delete [] offsets;
+        delete [] runs;
+        offsets = nullptr;
+        runs = nullptr;
+        runsNumber = 0;
+    }
+
+    // the runs of every cell lie between its offset and the next one, the
+    // offsets never go down and end at the number of runs, every move
+    // is one of the 8 or NO_MOVE
+    bool isConsistent()
+    {
+        if (offsets[0] != 0 || offsets[width * height] != runsNumber) return false;
+        for (int i = 0; i < width * height; i += 1)
+        {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        for (uint32_t i = 0; i < runsNumber; i += 1)
+        {
+            if ((runs[i] & ((1 << MOVE_BITS) - 1)) > NO_MOVE) return false;
+        }
+        return true;
+    }
+
+    // compresses the first moves of every source handed to this thread
+    void buildRows(GridSnapshot* grid, ArrayList<uint32_t>** rows)
+    {
+        BucketQueue<int> heap;
+        int* distTo = new int[width * height];
+        unsigned char* firstMove = new unsigned char[width * height];
+
+        for (int source = nextSource.fetch_add(1); source < width * height; source = nextSource.fetch_add(1))
+        {
+            Vector2I sourcePos = Vector2I{.x = source % width, .y = source / width};
+            if (!grid->isFree(sourcePos)) continue;
+
+            mapDistances(*grid, heap, source, distTo, firstMove);
+
+            // walls and the source itself are never asked for,
+            // so they join whatever run they are in
+            ArrayList<uint32_t>* row = new ArrayList<uint32_t>();
+            int lastMove = -1;
+            for (int target = 0; target < width * height; target += 1)
+            {
+                if (target == source || !grid->isFree(Vector2I{.x = target % width, .y = target / width})) continue;
+
+                int move = distTo[target] == -1 ? NO_MOVE : firstMove[target];
+                if (move == lastMove) continue;
+
+                uint32_t run = (uint32_t)(row->isEmpty() ? 0 : target) << MOVE_BITS | move;
+                row->push(run);
+                lastMove = move;
+            }
+            rows[source] = row;
+        }
+
+        delete [] distTo;
+        delete [] firstMove;
+    }
+
+public:
+    PathDatabase()
+    {
+        width = 0;
+        height = 0;
+        offsets = nullptr;
+        runs = nullptr;
+        runsNumber = 0;
+        wallsHash = 0;
+    }
+    ~PathDatabase()
+    {
+        release();
+    }
+
+    PathDatabase(const PathDatabase&) = delete;
+    PathDatabase& operator=(const PathDatabase&) = delete;
+
+    bool isBuilt() {return offsets != nullptr;}
+
+    // true if the database was built on the same walls as the engine has now
+    bool matches(SearchEngine& engine)
+    {
+        GridSnapshot grid;
+        grid.freeze(engine);
+        return isBuilt() && grid.hash() == wallsHash;
+    }
+
+    // builds the database on the walls of the engine, the sources are
+    // spread over the threads, zero threads means one per core
+    void build(SearchEngine& engine, int threadsCount = 0)
+    {
+        GridSnapshot grid;
+        grid.freeze(engine);
+
+        release();
+        width = grid.getWidth();
+        height = grid.getHeight();
+        wallsHash = grid.hash();
+
+        ArrayList<uint32_t>** rows = new ArrayList<uint32_t>*[width * height];
+        for (int i = 0; i < width * height; i += 1) rows[i] = nullptr;
+
+        int threadsNumber = threadsCount > 0 ? threadsCount : std::thread::hardware_concurrency();
+        if (threadsNumber <= 0) threadsNumber = 1;
+
+        nextSource = 0;
+        std::thread* threads = new std::thread[threadsNumber];
+        for (int i = 0; i < threadsNumber; i += 1)
+        {
+            threads[i] = std::thread(&PathDatabase::buildRows, this, &grid, rows);
+        }
+        for (int i = 0; i < threadsNumber; i += 1) threads[i].join();
+        delete [] threads;
+
+        // all the rows are put in one array
+        offsets = new uint32_t[width * height + 1];
+        runsNumber = 0;
+        for (int i = 0; i < width * height; i += 1)
+        {
+            offsets[i] = runsNumber;
+            if (rows[i] != nullptr) runsNumber += rows[i]->getSize();
+        }
+        offsets[width * height] = runsNumber;
+
+        runs = new uint32_t[runsNumber];
+        for (int i = 0; i < width * height; i += 1)
+        {
+            if (rows[i] == nullptr) continue;
+            for (int j = 0; j < rows[i]->getSize(); j += 1) runs[offsets[i] + j] = rows[i]->get(j);
+            delete rows[i];
+        }
+        delete [] rows;
+    }
+
+    // the file is a "CPD1" tag, the width, the height, the walls hash,
+    // the number of runs, the offsets and the runs, in the byte order of
+    // the machine saving it, a file is only read back on the same kind
+    bool save(const char* path)
+    {
+        if (!isBuilt()) return false;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        file.write("CPD1", 4);
+        file.write((const char*)&width, sizeof(width));
+        file.write((const char*)&height, sizeof(height));
+        file.write((const char*)&wallsHash, sizeof(wallsHash));
+        file.write((const char*)&runsNumber, sizeof(runsNumber));
+        file.write((const char*)offsets, sizeof(uint32_t) * (width * height + 1));
+        file.write((const char*)runs, sizeof(uint32_t) * runsNumber);
+        return (bool)file;
+    }
+
+    bool load(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        char tag[4];
+        file.read(tag, 4);
+        if (!file || memcmp(tag, "CPD1", 4) != 0) return false;
+
+        release();
+        file.read((char*)&width, sizeof(width));
+        file.read((char*)&height, sizeof(height));
+        file.read((char*)&wallsHash, sizeof(wallsHash));
+        file.read((char*)&runsNumber, sizeof(runsNumber));
+        if (!file || width <= 0 || height <= 0 || (long)width * height > DENSE_CELLS_LIMIT) return false;
+
+        // the rest of the file has to be the offsets and the runs exactly,
+        // so a broken header can't ask for more than the file holds
+        std::streampos start = file.tellg();
+        file.seekg(0, std::ios::end);
+        long rest = (long)(file.tellg() - start);
+        file.seekg(start);
+        if (rest != (long)sizeof(uint32_t) * ((long)width * height + 1 + runsNumber)) return false;
+
+        offsets = new uint32_t[width * height + 1];
+        runs = new uint32_t[runsNumber];
+        file.read((char*)offsets, sizeof(uint32_t) * (width * height + 1));
+        file.read((char*)runs, sizeof(uint32_t) * runsNumber);
+        if (!file || !isConsistent())
+        {
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // the first move from source toward target or NO_MOVE,
+    // a binary search over the runs of the source
+    int firstMove(Vector2I source, Vector2I target)
+    {
+        uint32_t first = offsets[source.y * width + source.x];
+        uint32_t last = offsets[source.y * width + source.x + 1];
+        if (first == last) return NO_MOVE;
+
+        uint32_t index = target.y * width + target.x;
+        while (last - first > 1)
+        {
+            uint32_t middle = first + (last - first) / 2;
+            if (runs[middle] >> MOVE_BITS <= index) first = middle;
+            else last = middle;
+        }
+        return runs[first] & ((1 << MOVE_BITS) - 1);
+    }
+
+    // the cells after source up to target, false if there is no path
+    bool findPath(Vector2I source, Vector2I target, ArrayList<Vector2I>& path)
+    {
+        path.clear();
+        if (!isBuilt() || !isInside(source) || !isInside(target)) return false;
+
+        // a path never visits a cell twice, so a longer walk means the
+        // database doesn't belong to these walls
+        for (Vector2I pos = source; pos != target; )
+        {
+            int move = firstMove(pos, target);
+            if (move == NO_MOVE || path.getSize() >= width * height) return false;
+
+            pos = Vector2I{.x = pos.x + MOVE_X[move], .y = pos.y + MOVE_Y[move]};
+            path.push(pos);
+        }
+        return true;
+    }
+
+    bool isInside(Vector2I pos)
+    {
+        return pos.x >= 0 && pos.y >= 0 && pos.x < width && pos.y < height;
+    }
+
+    int getRunsNumber() {return runsNumber;}
+};
+
+// answers queries from a path database, the database is built again
+// when the walls have changed since it was built or loaded
+class CPDEngine : public SearchEngine
+{
+
+private:
+    PathDatabase database;
+    bool stale;
+
+protected:
+    void onWallsChanged(Vector2I) override
+    {
+        stale = true;
+    }
+
+public:
+    const char* getName() override {return "cpd";}
+
+    CPDEngine()
+    {
+        stale = true;
+    }
+
+    PathDatabase& getDatabase() {return database;}
+
+    // uses a saved database if it was built on the current walls
+    bool loadDatabase(const char* path)
+    {
+        if (!database.load(path) || !database.matches(*this)) return false;
+        stale = false;
+        return true;
+    }
+
+    // the offline step, zero threads means one per core
+    void buildDatabase(int threadsCount = 0)
+    {
+        database.build(*this, threadsCount);
+        stale = false;
+    }
+
+    bool saveDatabase(const char* path)
+    {
+        return database.save(path);
+    }
+
+    void run() override
+    {
+        if (stale) buildDatabase();
+        resetSearch();
+        running = true;
+        currentPos = sourcePos;
+    }
+
+    // the whole path is read from the database in the first step
+    bool step() override
+    {
+        if (!running) return false;
+
+        if (!pathFound)
+        {
+            ArrayList<Vector2I> path;
+            if (!database.findPath(sourcePos, targetPos, path)) return false;
+
+            Vector2I before = sourcePos;
+            for (int i = 0; i < path.getSize(); i += 1)
+            {
+                from.insert(path.get(i), before);
+                before = path.get(i);
+            }
+            expanded = path.getSize();
+            pathFound = true;
+            currentPos = from.get(targetPos);
+            return true;
+        }
+        return SearchEngine::step();
+    }
+};
+
+#endif
@@ -0,0 +1,2194 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "../data_structures/hashtable.hpp"
+#include "../data_structures/flathashtable.hpp"
+#include "../data_structures/stampedgrid.hpp"
+#include "../data_structures/densegrid.hpp"
+#include "../data_structures/indexedheap.hpp"
+#include "../data_structures/bucketqueue.hpp"
+#include "../data_structures/chunkedgrid.hpp"
+#include "../data_structures/chunkedstampedgrid.hpp"
+#include "../data_structures/bitplane.hpp"
+#include "../data_structures/tileindex.hpp"
+#include "../data_structures/blockcounts.hpp"
+
+#include "./searchstats.hpp"
+
+// the search engine, it knows nothing about drawing or timing
+// so it can run headless as well as behind the visualizer
+
+#define CELLS_NUMBERS 800.0f
+
+// the side of the world, compile with -DCHUNKED_GRID to keep the cells in
+// chunks allocated on demand, the world is then much larger than the canvas
+// and only the touched part of it takes memory
+#if defined(CHUNKED_GRID)
+#define WORLD_CELLS (1 << 20)
+#else
+#define WORLD_CELLS ((int)CELLS_NUMBERS)
+#endif
+
+// engines that keep something for every cell of the map, not only for the
+// touched ones, refuse maps larger than this
+#define DENSE_CELLS_LIMIT (1 << 26)
+
+enum CellType
+{
+    CHECKED = 0, WALL = 1, PATH = 2, SOURCE = 3, TARGET = 4, REMOVE,
+};
+
+struct Cell
+{
+    CellType ct;
+    double st;
+};
+
+// every change of the walls of any engine gets a new version, so two
+// engines never share one for different walls
+inline uint64_t nextGridVersion()
+{
+    static std::atomic<uint64_t> versions(0);
+    return versions.fetch_add(1) + 1;
+}
+
+// mixes both coordinates so cells on the same diagonal don't collide
+inline size_t hashCell(int x, int y)
+{
+    uint64_t h = ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+struct Vector2I
+{
+    int x;
+    int y;
+    Vector2I& operator=(const Vector2I& v1)
+    {
+        this->x = v1.x;
+        this->y = v1.y;
+        return *this;
+    }
+
+    inline bool operator==(const Vector2I& rhs)
+    {
+        return this->x == rhs.x && this->y == rhs.y;
+    }
+
+    inline bool operator!=(const Vector2I& rhs)
+    {
+        return this->x != rhs.x || this->y != rhs.y;
+    }
+    size_t operator()(const Vector2I &p) const
+    {
+        return hashCell(p.x, p.y);
+    }
+
+};
+
+// stands for every cell when the walls may have changed anywhere
+const Vector2I ALL_CELLS = Vector2I{.x = -1, .y = -1};
+
+template<>
+struct std::hash<Vector2I>
+{
+    size_t operator()(const Vector2I &p) const
+    {
+        return hashCell(p.x, p.y);
+    }
+};
+
+// the tables holding the search state, stamped so a new search starts
+// without touching them, compile with -DHASHED_TABLES to use the
+// open-addressing table or with -DCHAINED_TABLES to use the chained one
+// the chunked world gets chunked tables unless a hashed one is asked for
+#if defined(CHAINED_TABLES)
+template <typename K, typename V> using SearchTable = Hashtable<K, V>;
+#elif defined(HASHED_TABLES)
+template <typename K, typename V> using SearchTable = FlatHashtable<K, V>;
+#elif defined(CHUNKED_GRID)
+template <typename K, typename V> using SearchTable = ChunkedStampedGrid<K, V>;
+#else
+template <typename K, typename V> using SearchTable = StampedGrid<K, V, (int)CELLS_NUMBERS, (int)CELLS_NUMBERS>;
+#endif
+
+// the widest and the highest map the search tables hold
+#if defined(CHAINED_TABLES) || defined(HASHED_TABLES) || defined(CHUNKED_GRID)
+#define SEARCH_TABLE_CELLS WORLD_CELLS
+#else
+#define SEARCH_TABLE_CELLS ((int)CELLS_NUMBERS)
+#endif
+
+// the open list, the costs are small integers so by default every key
+// gets its own bucket, compile with -DHEAP_OPEN_LIST to use the heap
+// with exact float keys
+#if defined(HEAP_OPEN_LIST)
+typedef float OpenKey;
+typedef IndexedHeap<Vector2I, OpenKey, SearchTable> OpenList;
+#else
+typedef int OpenKey;
+typedef BucketQueue<Vector2I, SearchTable> OpenList;
+#endif
+
+// the 8 moves, saved tables keep a move as its index here
+static const int MOVE_X[] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int MOVE_Y[] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+// the index of the move by x, y or -1
+inline int moveOf(int x, int y)
+{
+    for (int move = 0; move < 8; move += 1)
+    {
+        if (MOVE_X[move] == x && MOVE_Y[move] == y) return move;
+    }
+    return -1;
+}
+
+// the moves row by row, the order the searchers expand a cell in
+static const int ROW_MOVES[] = {5, 6, 7, 4, 0, 3, 2, 1};
+
+// goes over the free neighbors of a cell row by row like the searchers,
+// so every search breaks its ties the same way, a diagonal move needs
+// one of the two cells it passes by to be free
+// the grid only has to tell if a cell is free, the neighbors are asked
+// once in begin
+template <typename G>
+class NeighborIterator
+{
+private:
+    Vector2I pos;
+    // a bit for every place in ROW_MOVES whose move can be taken
+    unsigned int allowed;
+    // the place in ROW_MOVES of the last move given
+    int move;
+
+public:
+    NeighborIterator()
+    {
+        pos = Vector2I{.x = 0, .y = 0};
+        allowed = 0;
+        move = -1;
+    }
+
+    void begin(G& grid, Vector2I from)
+    {
+        pos = from;
+        unsigned int up = grid.isFree(Vector2I{.x = pos.x, .y = pos.y - 1});
+        unsigned int left = grid.isFree(Vector2I{.x = pos.x - 1, .y = pos.y});
+        unsigned int right = grid.isFree(Vector2I{.x = pos.x + 1, .y = pos.y});
+        unsigned int down = grid.isFree(Vector2I{.x = pos.x, .y = pos.y + 1});
+        allowed = up << 1 | left << 3 | right << 4 | down << 6;
+
+        // a diagonal is only looked at when one of the cells it passes by is free
+        if ((up | left) && grid.isFree(Vector2I{.x = pos.x - 1, .y = pos.y - 1})) allowed |= 1 << 0;
+        if ((up | right) && grid.isFree(Vector2I{.x = pos.x + 1, .y = pos.y - 1})) allowed |= 1 << 2;
+        if ((down | left) && grid.isFree(Vector2I{.x = pos.x - 1, .y = pos.y + 1})) allowed |= 1 << 5;
+        if ((down | right) && grid.isFree(Vector2I{.x = pos.x + 1, .y = pos.y + 1})) allowed |= 1 << 7;
+        move = -1;
+    }
+
+    bool hasNext()
+    {
+        return allowed != 0;
+    }
+
+    Vector2I next()
+    {
+        if (allowed == 0)
+        {
+            throw std::runtime_error("The iterator has no next value");
+        }
+        move = __builtin_ctz(allowed);
+        allowed &= allowed - 1;
+        return Vector2I{.x = pos.x + MOVE_X[ROW_MOVES[move]], .y = pos.y + MOVE_Y[ROW_MOVES[move]]};
+    }
+
+    // the index of the last move given by next and its cost
+    int getMove() {return ROW_MOVES[move];}
+    int getCost() {return abs(MOVE_X[ROW_MOVES[move]]) + abs(MOVE_Y[ROW_MOVES[move]]);}
+};
+
+// every cell of the world, stored densely so a lookup is a single load
+// compile with -DHASHED_GRID to keep only the touched cells in a hashtable
+// or with -DCHUNKED_GRID to keep them in chunks of dense cells
+#if defined(HASHED_GRID)
+typedef FlatHashtable<Vector2I, Cell> GridTable;
+#elif defined(CHUNKED_GRID)
+typedef ChunkedGrid<Vector2I, Cell> GridTable;
+#else
+typedef DenseGrid<Vector2I, Cell, (int)CELLS_NUMBERS, (int)CELLS_NUMBERS> GridTable;
+#endif
+
+class SearchEngine
+{
+protected:
+    GridTable grid;
+
+    // the part of the grid the search may use
+    int width;
+    int height;
+
+    bool running;
+    bool pathFound;
+
+    Vector2I sourcePos;
+    Vector2I targetPos;
+    Vector2I currentPos;
+
+    // searching
+    OpenList heap;
+
+    // contains the cell's key as a key,
+    // and the distance to the source as the value
+    SearchTable<Vector2I, int> distTo;
+
+    // contains the cell's key as a key,
+    // and the key of the cell before it
+    SearchTable<Vector2I, Vector2I> from;
+
+    // the time given to the cells put by the search
+    double now;
+
+    // changes with every wall put or removed, see nextGridVersion
+    uint64_t gridVersion;
+    // true while a reset puts the same walls back
+    bool puttingBackWalls;
+
+    // the walls of a map opened with mapWalls, a cell is only looked up
+    // here when the grid has nothing at it, the walls drawn afterwards
+    // go to the grid
+    BitPlane wallPlane;
+
+    // the cells changed since forgetChanges, only kept while recording
+    // so a headless run doesn't pay for them, once everything changed
+    // the cells aren't listed anymore
+    bool recording;
+    bool everythingChanged;
+    ArrayList<Vector2I> changedCells;
+
+    // every cell written while recording, by tile, so the cells of a part
+    // of the grid are found without going over the rest
+    TileIndex<Vector2I> touchedTiles;
+
+    // the cells of every type in every block of the grid while recording,
+    // the mapped walls aren't counted
+    BlockCounts<Vector2I> blockCounts;
+
+    // every cell written goes here too while it's set, see logChanges
+    ArrayList<Vector2I>* changeLog;
+
+    // the work done by the last search
+    int expanded;
+    int generated;
+    int pushes;
+    int decreases;
+
+    // helper methods
+    // ---------------------------------------------------------------------------------------------------------
+
+    int edgeCost(Vector2I vertex, Vector2I fromVertex)
+    {
+        int dx = vertex.x - fromVertex.x;
+        int dy = vertex.y - fromVertex.y;
+        return abs(dx) + abs(dy);
+    }
+
+    // the key of a vertex in the heap
+    virtual OpenKey priority(Vector2I vertex)
+    {
+        return distTo.get(vertex);
+    }
+
+    virtual void addEdgeFrom(Vector2I vertex, Vector2I fromVertex)
+    {
+        distTo.insert(vertex, distTo.get(fromVertex) + edgeCost(vertex, fromVertex));
+        from.insert(vertex, fromVertex);
+        heap.add(vertex, priority(vertex));
+        pushes += 1;
+    }
+
+    // called when a vertex that is still in the heap is reached again,
+    // moves it up if the new way to it is shorter
+    virtual void relaxEdge(Vector2I vertex, Vector2I fromVertex)
+    {
+        int distance = distTo.get(fromVertex) + edgeCost(vertex, fromVertex);
+        if (distance >= distTo.get(vertex)) return;
+
+        distTo.insert(vertex, distance);
+        from.insert(vertex, fromVertex);
+        heap.decreaseKey(vertex, priority(vertex));
+        decreases += 1;
+    }
+
+    // every real change of the walls goes through here, key is the cell
+    // whose wall was put or taken away, or ALL_CELLS when the walls may
+    // have changed anywhere
+    void wallsChanged(Vector2I key)
+    {
+        if (puttingBackWalls) return;
+        gridVersion = nextGridVersion();
+        onWallsChanged(key);
+    }
+
+    // lets an engine drop what it built on the old walls
+    virtual void onWallsChanged(Vector2I) {}
+
+    void cellChanged(Vector2I key)
+    {
+        if (changeLog != nullptr) changeLog->push(key);
+        if (!recording) return;
+        if (!everythingChanged) changedCells.push(key);
+        touchedTiles.add(key);
+    }
+
+    // the grid is only written through these two, so the recorded
+    // changes and the block counts follow it
+    void setCell(Vector2I key, Cell cell)
+    {
+        if (recording)
+        {
+            blockCounts.remove(key, storedTypeAt(key));
+            blockCounts.add(key, cell.ct);
+        }
+        grid.insert(key, cell);
+        cellChanged(key);
+    }
+
+    void unsetCell(Vector2I key)
+    {
+        if (recording) blockCounts.remove(key, storedTypeAt(key));
+        grid.remove(key);
+        cellChanged(key);
+    }
+
+    void allCellsChanged()
+    {
+        if (!recording) return;
+        everythingChanged = true;
+        changedCells.clear();
+    }
+
+    // the type of the cell the grid has at key or -1 if it has none
+    int storedTypeAt(Vector2I key)
+    {
+    #if defined(HASHED_GRID)
+        Cell* cell = grid.find(key);
+        return cell == nullptr ? -1 : cell->ct;
+    #else
+        return grid.typeOf(key);
+    #endif
+    }
+
+    // the type of the cell at key or -1 if the cell is empty
+    int typeAt(Vector2I key)
+    {
+        int type = storedTypeAt(key);
+        if (type == -1 && wallPlane.get(key.x, key.y)) return WALL;
+        return type;
+    }
+
+    // takes away the wall at key, from the grid or from the mapped walls
+    void removeWall(Vector2I key)
+    {
+        if (grid.containsKey(key)) unsetCell(key);
+        else
+        {
+            wallPlane.set(key.x, key.y, false);
+            cellChanged(key);
+        }
+        wallsChanged(key);
+    }
+
+    bool isGoodCorner(Vector2I pos, int x, int y)
+    {
+        Vector2I firstWall = Vector2I{.x = x + pos.x, .y = pos.y};
+        Vector2I secondWall = Vector2I{.x = pos.x, .y = y + pos.y};
+
+        return typeAt(firstWall) != WALL || typeAt(secondWall) != WALL;
+    }
+
+    // true if the move from pos by x, y can't start a shortest path
+    // to the target, so expand skips it
+    virtual bool prunes(Vector2I, int, int)
+    {
+        return false;
+    }
+
+    // the cell after pos when walking the path back to the source
+    virtual Vector2I nextOnPath(Vector2I pos)
+    {
+        return from.get(pos);
+    }
+
+    // adds the neighbors of pos to the heap
+    virtual void expand(Vector2I pos)
+    {
+        for (int y = -1; y <= 1; y += 1)
+        {
+            for (int x = -1; x <= 1; x += 1)
+            {
+                if (abs(x) == abs(y))
+                {
+                    if (!isGoodCorner(pos, x, y)) continue;
+                }
+                if (prunes(pos, x, y)) continue;
+                Vector2I newPos = (Vector2I){pos.x + x, pos.y + y};
+                generated += 1;
+
+                if (newPos == targetPos && !from.containsKey(targetPos))
+                {
+                    addEdgeFrom(newPos, pos);
+                }
+                // only add the new cell if it's added to the grid successfully
+                else if (putToGrid(newPos, CHECKED, now))
+                {
+                    addEdgeFrom(newPos, pos);
+                }
+                // cells already in the heap may have a shorter way now
+                else if (heap.contains(newPos))
+                {
+                    relaxEdge(newPos, pos);
+                }
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------------------
+
+public:
+    SearchEngine()
+    {
+    #if !defined(HASHED_GRID)
+        // the cells of a search go away with it
+        grid.markTransient(CHECKED);
+        grid.markTransient(PATH);
+    #endif
+        blockCounts.markTransient(CHECKED);
+        blockCounts.markTransient(PATH);
+        width = WORLD_CELLS;
+        height = WORLD_CELLS;
+
+        running = false;
+        pathFound = false;
+
+        sourcePos = Vector2I{.x = -1, .y = -1};
+        targetPos = Vector2I{.x = -1, .y = -1};
+        currentPos = sourcePos;
+
+        now = 0;
+        gridVersion = nextGridVersion();
+        puttingBackWalls = false;
+        recording = false;
+        everythingChanged = false;
+        changeLog = nullptr;
+        expanded = 0;
+        generated = 0;
+        pushes = 0;
+        decreases = 0;
+    }
+    virtual ~SearchEngine() {}
+
+    SearchEngine(const SearchEngine&) = delete;
+    SearchEngine& operator=(const SearchEngine&) = delete;
+
+    virtual bool isValidCell(Vector2I cell)
+    {
+        return cell.x >= 0 && cell.y >= 0 &&
+                cell.x < width && cell.y < height;
+    }
+
+    bool isFree(Vector2I pos)
+    {
+        return isValidCell(pos) && typeAt(pos) != WALL;
+    }
+
+    // puts a cell to the grid, returns true only if the search may use it
+    virtual bool putToGrid(Vector2I key, CellType ct, double time)
+    {
+        if (!isValidCell(key)) return false;
+
+        if (running)
+        {
+            // cell is not inserted if it's place is occupied by
+            // a wall or something of the same type
+            if (typeAt(key) >= (int)ct) return false;
+        }
+        else if (ct == REMOVE)
+        {
+            // user can only remove the walls
+            if (typeAt(key) == WALL) removeWall(key);
+            return false;
+        }
+
+        else if (typeAt(key) != -1) return false;
+
+        else if (ct == SOURCE)
+        {
+            if (grid.containsKey(sourcePos)) unsetCell(sourcePos);
+
+            setCell(key, {ct, time});
+            sourcePos = key;
+            return false;
+        }
+        else if (ct == TARGET)
+        {
+            if (grid.containsKey(targetPos)) unsetCell(targetPos);
+
+            setCell(key, {ct, time});
+            targetPos = key;
+            return false;
+        }
+
+        setCell(key, {ct, time});
+        if (ct == WALL) wallsChanged(key);
+        return true;
+    }
+
+    // limits the search to the first w columns and h rows of the grid
+    virtual void setSize(int w, int h)
+    {
+        if (w > WORLD_CELLS || h > WORLD_CELLS)
+        {
+            throw std::runtime_error("The size is bigger than the grid");
+        }
+        width = w;
+        height = h;
+        wallsChanged(ALL_CELLS);
+        allCellsChanged();
+    }
+
+    // takes the source and the target out of the grid
+    virtual void removeEndpoints()
+    {
+        resetSearch();
+        if (grid.containsKey(sourcePos)) unsetCell(sourcePos);
+        if (grid.containsKey(targetPos)) unsetCell(targetPos);
+        sourcePos = Vector2I{.x = -1, .y = -1};
+        targetPos = sourcePos;
+    }
+
+    // moves the source and the target, returns false if one of them
+    // can't be put there
+    virtual bool setEndpoints(Vector2I source, Vector2I target)
+    {
+        removeEndpoints();
+
+        if (source == target || !isValidCell(source) || !isValidCell(target)) return false;
+        if (typeAt(source) != -1 || typeAt(target) != -1) return false;
+
+        putToGrid(source, SOURCE, now);
+        putToGrid(target, TARGET, now);
+        return true;
+    }
+
+    virtual void resetSearch()
+    {
+    #if !defined(HASHED_GRID)
+        // the walls, the source and the target stay where they are
+        heap.clear();
+        distTo.clear();
+        from.clear();
+        grid.clearTransient();
+        blockCounts.clearTransient();
+        allCellsChanged();
+
+        running = false;
+        pathFound = false;
+    #else
+        // the same walls are put back, so nothing is told they changed
+        puttingBackWalls = true;
+        BitPlane mappedWalls;
+        mappedWalls.swap(wallPlane);
+        ArrayList<Vector2I> walls;
+        GridTable::HashIterator iter;
+        iter.begin(grid);
+        while (iter.hasNext())
+        {
+            iter.next();
+            if (iter.getValue().ct == WALL) walls.push(iter.getKey());
+        }
+        clear();
+        for (int i = 0; i < walls.getSize(); i += 1) putToGrid(walls.get(i), WALL, 0);
+        wallPlane.swap(mappedWalls);
+        puttingBackWalls = false;
+    #endif
+        expanded = 0;
+        generated = 0;
+        pushes = 0;
+        decreases = 0;
+    }
+
+    virtual void run()
+    {
+        resetSearch();
+        running = true;
+        currentPos = sourcePos;
+
+        from.insert(sourcePos, Vector2I{.x = -1000, .y = -1000});
+        distTo.insert(sourcePos, 0);
+
+        heap.add(sourcePos, 0);
+        pushes += 1;
+    }
+
+    // removes everything but the source and the target
+    virtual void clear()
+    {
+        heap.clear();
+        distTo.clear();
+        from.clear();
+
+        bool hasSource = grid.containsKey(sourcePos);
+        bool hasTarget = grid.containsKey(targetPos);
+        double sourceTime = hasSource ? grid.get(sourcePos).st : 0;
+        double targetTime = hasTarget ? grid.get(targetPos).st : 0;
+
+        grid.clear();
+        touchedTiles.clear();
+        blockCounts.clear();
+        if (hasSource) setCell(sourcePos, {SOURCE, sourceTime});
+        if (hasTarget) setCell(targetPos, {TARGET, targetTime});
+        wallPlane.release();
+        wallsChanged(ALL_CELLS);
+        allCellsChanged();
+
+        running = false;
+        pathFound = false;
+    }
+
+    // does one step of the search, expanding one cell or adding one cell
+    // of the path, returns false once there is nothing left to do
+    virtual bool step()
+    {
+        if (!running) return false;
+
+        if (!pathFound)
+        {
+            if (heap.isEmpty()) return false;
+
+            currentPos = heap.removeSmallest();
+            expanded += 1;
+
+            // the target is only final once it leaves the heap
+            if (currentPos == targetPos)
+            {
+                pathFound = true;
+                currentPos = nextOnPath(targetPos);
+                return true;
+            }
+
+            expand(currentPos);
+            return true;
+        }
+
+        if (currentPos != sourcePos)
+        {
+            putToGrid(currentPos, PATH, now);
+            currentPos = nextOnPath(currentPos);
+            return true;
+        }
+        return false;
+    }
+
+    // the cells of the found path from the target back to the source,
+    // the source itself is left out
+    void getPath(ArrayList<Vector2I>& path)
+    {
+        path.clear();
+        if (!pathFound) return;
+        for (Vector2I pos = targetPos; pos != sourcePos; pos = from.get(pos)) path.push(pos);
+    }
+
+    // puts back a path found earlier for the same endpoints and walls
+    // instead of searching, step() only walks it
+    virtual void replayPath(bool found, ArrayList<Vector2I>& path)
+    {
+        resetSearch();
+        if (!found) return;
+
+        running = true;
+        for (int i = 0; i < path.getSize(); i += 1)
+        {
+            Vector2I before = i + 1 < path.getSize() ? path.get(i + 1) : sourcePos;
+            from.insert(path.get(i), before);
+        }
+        pathFound = true;
+        currentPos = nextOnPath(targetPos);
+    }
+
+    // shows a search another engine runs on the same walls and endpoints,
+    // its cells are put here with putToGrid and step() has nothing to do
+    virtual void follow()
+    {
+        resetSearch();
+        running = true;
+        currentPos = sourcePos;
+    }
+
+    // takes the outcome of the search followed since follow(), the other
+    // engine is done with it, so the path and the work done are known here
+    void takeSearch(SearchEngine& other)
+    {
+        ArrayList<Vector2I> path;
+        other.getPath(path);
+        for (int i = 0; i < path.getSize(); i += 1)
+        {
+            Vector2I before = i + 1 < path.getSize() ? path.get(i + 1) : sourcePos;
+            from.insert(path.get(i), before);
+        }
+        pathFound = other.pathFound;
+        currentPos = sourcePos;
+
+        expanded = other.expanded;
+        generated = other.generated;
+        pushes = other.pushes;
+        decreases = other.decreases;
+    }
+
+    // runs the search started by run() to its end
+    virtual void solve()
+    {
+        while (step()) {}
+    }
+
+    // the sum of the edge costs along the found path
+    virtual int getPathCost()
+    {
+        if (!pathFound) return -1;
+
+        int cost = 0;
+        for (Vector2I pos = targetPos; pos != sourcePos; pos = from.get(pos))
+        {
+            cost += edgeCost(pos, from.get(pos));
+        }
+        return cost;
+    }
+
+    // the number of moves along the found path
+    virtual int getPathLength()
+    {
+        if (!pathFound) return -1;
+
+        int length = 0;
+        for (Vector2I pos = targetPos; pos != sourcePos; pos = from.get(pos))
+        {
+            Vector2I before = from.get(pos);
+            length += std::max(abs(pos.x - before.x), abs(pos.y - before.y));
+        }
+        return length;
+    }
+
+    void setTime(double time) {now = time;}
+
+    GridTable& getGrid() {return grid;}
+
+    // the walls mapped by mapWalls, empty if there are none
+    BitPlane& getWallPlane() {return wallPlane;}
+
+    // the type of the cell at key or -1 if the cell is empty
+    int getCellType(Vector2I key) {return typeAt(key);}
+
+    // starts or stops listing the changed cells, everything counts as
+    // changed when it starts
+    void recordChanges(bool record)
+    {
+        recording = record;
+        everythingChanged = true;
+        changedCells.clear();
+
+        touchedTiles.clear();
+        blockCounts.clear();
+        if (!recording) return;
+
+        GridTable::HashIterator iter;
+        iter.begin(grid);
+        while (iter.hasNext())
+        {
+            iter.next();
+            touchedTiles.add(iter.getKey());
+            blockCounts.add(iter.getKey(), iter.getValue().ct);
+        }
+    }
+
+    // the cells put or taken away since forgetChanges, may hold a cell twice
+    ArrayList<Vector2I>& getChangedCells() {return changedCells;}
+
+    // true if too much changed to list it, every cell has to be read again
+    bool hasEverythingChanged() {return everythingChanged;}
+
+    // the cells written while recording, found by their tile, some may be
+    // empty again, the mapped walls aren't in it
+    TileIndex<Vector2I>& getTouchedTiles() {return touchedTiles;}
+
+    // the cells of every type in every block, kept while recording
+    BlockCounts<Vector2I>& getBlockCounts() {return blockCounts;}
+
+    void forgetChanges()
+    {
+        everythingChanged = false;
+        if (changedCells.getSize() > 0) changedCells.clear();
+    }
+
+    // opens a map saved by saveWalls, the file is mapped and read in place
+    // so it opens at once whatever its size, everything but the source and
+    // the target is cleared, returns false if the file isn't a saved map
+    bool mapWalls(const char* path)
+    {
+        BitPlane walls;
+        if (!walls.map(path)) return false;
+
+        clear();
+        setSize(walls.getWidth(), walls.getHeight());
+        wallPlane.swap(walls);
+        wallsChanged(ALL_CELLS);
+        allCellsChanged();
+        return true;
+    }
+
+    // saves every wall of the map in the format mapWalls opens
+    bool saveWalls(const char* path)
+    {
+        BitPlane walls;
+        walls.create(width, height);
+        if (wallPlane.getWidth() == width && wallPlane.getHeight() == height) walls.copy(wallPlane);
+        else
+        {
+            for (int y = 0; y < std::min(height, wallPlane.getHeight()); y += 1)
+            {
+                for (int x = 0; x < std::min(width, wallPlane.getWidth()); x += 1)
+                {
+                    if (wallPlane.get(x, y)) walls.set(x, y, true);
+                }
+            }
+        }
+
+        GridTable::HashIterator iter;
+        iter.begin(grid);
+        while (iter.hasNext())
+        {
+            iter.next();
+            Vector2I key = iter.getKey();
+            if (iter.getValue().ct == WALL && walls.isInside(key.x, key.y)) walls.set(key.x, key.y, true);
+        }
+        return walls.save(path);
+    }
+
+    // every cell written from now on is pushed to log as well, whether
+    // recording or not, nullptr stops it
+    void logChanges(ArrayList<Vector2I>* log) {changeLog = log;}
+
+    // puts the same walls and size as another engine has, everything else
+    // is cleared, the walls keep the other engine's version
+    void copyWalls(SearchEngine& other)
+    {
+        clear();
+        setSize(other.width, other.height);
+        if (other.wallPlane.isLoaded())
+        {
+            wallPlane.create(other.wallPlane.getWidth(), other.wallPlane.getHeight());
+            wallPlane.copy(other.wallPlane);
+        }
+
+        GridTable::HashIterator iter;
+        iter.begin(other.grid);
+        while (iter.hasNext())
+        {
+            iter.next();
+            if (iter.getValue().ct == WALL) setCell(iter.getKey(), {WALL, 0});
+        }
+        gridVersion = other.gridVersion;
+    }
+
+    // takes the walls and the size of another engine, the grid walls are
+    // left to the caller to put
+    void takeWalls(SearchEngine& other)
+    {
+        setSize(other.getWidth(), other.getHeight());
+        wallPlane.swap(other.wallPlane);
+        other.wallPlane.release();
+        wallsChanged(ALL_CELLS);
+        allCellsChanged();
+    }
+
+    Vector2I getSourcePos() {return sourcePos;}
+    Vector2I getTargetPos() {return targetPos;}
+    Vector2I getCurrentPos() {return currentPos;}
+
+    int getWidth() {return width;}
+    int getHeight() {return height;}
+
+    int getExpanded() {return expanded;}
+    int getGenerated() {return generated;}
+    int getPushes() {return pushes;}
+    int getPops() {return expanded;}
+    int getDecreases() {return decreases;}
+
+    // the counters of the search and its tables, the phase times and the
+    // list resizes are left as they are for the caller to fill
+    virtual void getStats(SearchStats& stats)
+    {
+        stats.algorithm = getName();
+        stats.pathFound = pathFound;
+        stats.pathCost = getPathCost();
+        stats.expanded = expanded;
+        stats.generated = generated;
+        stats.pushes = pushes;
+        stats.pops = expanded;
+        stats.decreases = decreases;
+        stats.maxOpenSize = heap.getMaxSize();
+
+        stats.probes = 0;
+        stats.rehashes = 0;
+        stats.longestBucket = 0;
+        addTableStats(stats, heap.getIndex());
+        addTableStats(stats, distTo);
+        addTableStats(stats, from);
+    }
+
+    bool isRunning() {return running;}
+
+    uint64_t getGridVersion() {return gridVersion;}
+
+    // the name the cli and the caches know the engine by
+    virtual const char* getName() {return "dijkstra";}
+
+    // only engines that can repair their search take wall edits while running
+    virtual bool editsWhileRunning() {return false;}
+
+    bool isPathFound() {return pathFound;}
+};
+
+
+
+class DijkstraEngine : public SearchEngine
+{
+};
+
+
+
+class AStarEngine : public SearchEngine
+{
+
+protected:
+
+    virtual float heuristic(Vector2I vertex)
+    {
+        float dx = vertex.x - targetPos.x;
+        float dy = vertex.y - targetPos.y;
+        return sqrt(pow(dx, 2) + pow(dy, 2));
+    }
+
+    // with integer keys the heuristic is rounded down,
+    // which keeps it admissible and consistent
+    OpenKey priority(Vector2I vertex) override
+    {
+        return distTo.get(vertex) + heuristic(vertex);
+    }
+
+public:
+    const char* getName() override {return "astar";}
+};
+
+class BFSEngine : public AStarEngine
+{
+
+private:
+    OpenKey priority(Vector2I vertex) override
+    {
+        return heuristic(vertex);
+    }
+
+    // greedy search doesn't keep distances, the first way to a cell is kept
+    void addEdgeFrom(Vector2I vertex, Vector2I fromVertex) override
+    {
+        from.insert(vertex, fromVertex);
+        heap.add(vertex, priority(vertex));
+        pushes += 1;
+    }
+
+    void relaxEdge(Vector2I, Vector2I) override
+    {
+    }
+
+public:
+    const char* getName() override {return "bfs";}
+};
+
+// jump point search, instead of adding every neighbor it follows every
+// direction that isn't pruned until a jump point and only adds that
+//
+// a diagonal move costs as much as the two straight moves around it and
+// the corner rule always leaves one of them free, so every shortest path
+// has a straight only twin, the pruning works on those paths which go
+// horizontally first and only turn vertically where they have to
+class JPSEngine : public AStarEngine
+{
+
+private:
+    // the jump point the path is walked to
+    Vector2I heading;
+
+    bool isWalkable(int x, int y)
+    {
+        Vector2I pos = Vector2I{.x = x, .y = y};
+        return isValidCell(pos) && typeAt(pos) != WALL;
+    }
+
+    int sign(int n)
+    {
+        return (n > 0) - (n < 0);
+    }
+
+    // a cell reached vertically has to turn when the cell beside it
+    // can't be reached horizontally from the cell before it
+    bool hasForcedNeighbor(int x, int y, int dy)
+    {
+        return (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy)) ||
+                (isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy));
+    }
+
+    // walks from pos in the direction (dx, dy) until a jump point
+    // returns false if a wall or the end of the grid comes first
+    bool jump(Vector2I pos, int dx, int dy, Vector2I* point)
+    {
+        int x = pos.x;
+        int y = pos.y;
+
+        while (true)
+        {
+            x += dx;
+            y += dy;
+            if (!isWalkable(x, y)) return false;
+
+            *point = Vector2I{.x = x, .y = y};
+            if (*point == targetPos) return true;
+
+            if (dx == 0)
+            {
+                if (hasForcedNeighbor(x, y, dy)) return true;
+            }
+            else
+            {
+                // a horizontal move stops where one of its vertical parts finds a jump point
+                Vector2I verticalPoint;
+                if (jump(*point, 0, 1, &verticalPoint) || jump(*point, 0, -1, &verticalPoint)) return true;
+            }
+        }
+    }
+
+    // adds the jump point found in the direction (dx, dy) from pos
+    void jumpFrom(Vector2I pos, int dx, int dy)
+    {
+        Vector2I point;
+        if (!jump(pos, dx, dy, &point)) return;
+        generated += 1;
+
+        if (point == targetPos && !from.containsKey(targetPos))
+        {
+            addEdgeFrom(point, pos);
+        }
+        else if (putToGrid(point, CHECKED, now))
+        {
+            addEdgeFrom(point, pos);
+        }
+        else if (heap.contains(point))
+        {
+            relaxEdge(point, pos);
+        }
+    }
+
+protected:
+    // every path is made of straight moves, so the manhattan
+    // distance is exact on an open grid and still admissible
+    OpenKey priority(Vector2I vertex) override
+    {
+        return distTo.get(vertex) + abs(vertex.x - targetPos.x) + abs(vertex.y - targetPos.y);
+    }
+
+    // only the directions that may lead to a shorter path than
+    // going through the parent are followed
+    void expand(Vector2I pos) override
+    {
+        Vector2I parent = from.get(pos);
+        int dx = sign(pos.x - parent.x);
+        int dy = sign(pos.y - parent.y);
+
+        if (pos == sourcePos || dx != 0)
+        {
+            if (pos == sourcePos || dx == 1) jumpFrom(pos, 1, 0);
+            if (pos == sourcePos || dx == -1) jumpFrom(pos, -1, 0);
+            jumpFrom(pos, 0, 1);
+            jumpFrom(pos, 0, -1);
+            return;
+        }
+
+        jumpFrom(pos, 0, dy);
+        if (isWalkable(pos.x + 1, pos.y) && !isWalkable(pos.x + 1, pos.y - dy)) jumpFrom(pos, 1, 0);
+        if (isWalkable(pos.x - 1, pos.y) && !isWalkable(pos.x - 1, pos.y - dy)) jumpFrom(pos, -1, 0);
+    }
+
+    // the cells between two jump points are on a straight line
+    Vector2I nextOnPath(Vector2I pos) override
+    {
+        // at a jump point the path goes on to its parent
+        if (pos == targetPos || pos == heading) heading = from.get(pos);
+        return Vector2I{.x = pos.x + sign(heading.x - pos.x), .y = pos.y + sign(heading.y - pos.y)};
+    }
+
+public:
+    const char* getName() override {return "jps";}
+
+    JPSEngine()
+    {
+        heading = Vector2I{.x = -1, .y = -1};
+    }
+};
+
+// bidirectional A*, one frontier grows from the source and one from the
+// target, each with its own open list and tables
+// solve() runs the two frontiers on their own threads, step() takes turns
+// between them so the visualizer can animate the search
+class BidirectionalEngine : public SearchEngine
+{
+
+private:
+    static const int NO_DISTANCE = 0x3FFFFFFF;
+
+    struct Frontier
+    {
+        OpenList heap;
+        SearchTable<Vector2I, int> distTo;
+        SearchTable<Vector2I, Vector2I> from;
+
+        // the endpoint this frontier heads to
+        Vector2I goal;
+
+        // the distance of every reached cell, written for the other frontier
+        // touched keeps the reached cells so a new search resets only them
+        std::atomic<int>* reached;
+        int reachedSize;
+        ArrayList<int> touched;
+
+        int expanded;
+        int generated;
+        int pushes;
+        int decreases;
+
+        Frontier()
+        {
+            reached = nullptr;
+            reachedSize = 0;
+            expanded = 0;
+            generated = 0;
+            pushes = 0;
+            decreases = 0;
+        }
+        ~Frontier()
+        {
+            delete [] reached;
+        }
+
+        // one distance for every cell of the map, allocated again
+        // only when the map changes size
+        void fit(int size)
+        {
+            if (size == reachedSize) return;
+
+            delete [] reached;
+            reached = new std::atomic<int>[size];
+            for (int i = 0; i < size; i += 1) reached[i] = NO_DISTANCE;
+            reachedSize = size;
+            touched.clear();
+        }
+    };
+
+    Frontier forward;
+    Frontier backward;
+
+    // the cost of the shortest path seen so far and the cell where the two
+    // frontiers met on it
+    std::atomic<int> best;
+    Vector2I meetPos;
+    std::mutex meetLock;
+
+    // set once one frontier proves that no shorter path is left
+    std::atomic<bool> stopped;
+    bool forwardTurn;
+
+    int indexOf(Vector2I pos)
+    {
+        return pos.y * width + pos.x;
+    }
+
+    OpenKey frontierPriority(Frontier& f, Vector2I vertex)
+    {
+        float dx = vertex.x - f.goal.x;
+        float dy = vertex.y - f.goal.y;
+        return f.distTo.get(vertex) + sqrt(dx * dx + dy * dy);
+    }
+
+    void publish(Frontier& f, Vector2I pos, int distance)
+    {
+        int index = indexOf(pos);
+        if (f.reached[index] == NO_DISTANCE) f.touched.push(index);
+        f.reached[index] = distance;
+    }
+
+    void meet(Vector2I pos, int distance)
+    {
+        if (distance >= best) return;
+
+        std::lock_guard<std::mutex> lock(meetLock);
+        if (distance < best)
+        {
+            best = distance;
+            meetPos = pos;
+        }
+    }
+
+    void resetFrontier(Frontier& f, Vector2I start, Vector2I goal)
+    {
+        f.heap.clear();
+        f.distTo.clear();
+        f.from.clear();
+        for (int i = 0; i < f.touched.getSize(); i += 1) f.reached[f.touched.get(i)] = NO_DISTANCE;
+        f.touched.clear();
+
+        f.goal = goal;
+        f.expanded = 0;
+        f.generated = 0;
+        f.pushes = 0;
+        f.decreases = 0;
+
+        if (!isValidCell(start)) return;
+        f.distTo.insert(start, 0);
+        f.from.insert(start, Vector2I{.x = -1000, .y = -1000});
+        f.heap.add(start, frontierPriority(f, start));
+        f.pushes += 1;
+        publish(f, start, 0);
+    }
+
+    // expands the smallest cell of f, returns false once f can't
+    // lead to a shorter path, cells are only drawn when show is set
+    bool advance(Frontier& f, Frontier& other, bool show)
+    {
+        // every path through the open cells of f costs at least their key
+        if (f.heap.isEmpty() || f.heap.getSmallestP() >= best) return false;
+
+        Vector2I pos = f.heap.removeSmallest();
+        f.expanded += 1;
+        if (show) currentPos = pos;
+
+        int distance = f.distTo.get(pos);
+
+        NeighborIterator<SearchEngine> iter;
+        iter.begin(*this, pos);
+        while (iter.hasNext())
+        {
+            Vector2I newPos = iter.next();
+            f.generated += 1;
+
+            int newDistance = distance + iter.getCost();
+            int* oldDistance = f.distTo.find(newPos);
+
+            if (oldDistance == nullptr)
+            {
+                f.distTo.insert(newPos, newDistance);
+                f.from.insert(newPos, pos);
+                f.heap.add(newPos, frontierPriority(f, newPos));
+                f.pushes += 1;
+                if (show) putToGrid(newPos, CHECKED, now);
+            }
+            else if (newDistance < *oldDistance && f.heap.contains(newPos))
+            {
+                *oldDistance = newDistance;
+                f.from.insert(newPos, pos);
+                f.heap.decreaseKey(newPos, frontierPriority(f, newPos));
+                f.decreases += 1;
+            }
+            else continue;
+
+            // the other frontier reads this before or after writing its own
+            // distance, so at least one of them sees the meeting
+            publish(f, newPos, newDistance);
+            int otherDistance = other.reached[indexOf(newPos)];
+            if (otherDistance != NO_DISTANCE) meet(newPos, newDistance + otherDistance);
+        }
+        return true;
+    }
+
+    void countWork()
+    {
+        expanded = forward.expanded + backward.expanded;
+        generated = forward.generated + backward.generated;
+        pushes = forward.pushes + backward.pushes;
+        decreases = forward.decreases + backward.decreases;
+    }
+
+    // joins the two halves of the path at the meeting cell
+    void finish()
+    {
+        stopped = true;
+        countWork();
+        if (best == NO_DISTANCE) return;
+
+        for (Vector2I pos = meetPos; pos != sourcePos; pos = forward.from.get(pos))
+        {
+            from.insert(pos, forward.from.get(pos));
+        }
+        Vector2I before = meetPos;
+        for (Vector2I pos = meetPos; pos != targetPos; )
+        {
+            pos = backward.from.get(pos);
+            from.insert(pos, before);
+            before = pos;
+        }
+
+        pathFound = true;
+        currentPos = from.get(targetPos);
+    }
+
+public:
+    const char* getName() override {return "bidirectional";}
+
+    // the work is done by the frontiers, the open list size is the most
+    // both of them held at once at most
+    void getStats(SearchStats& stats) override
+    {
+        SearchEngine::getStats(stats);
+        stats.maxOpenSize = forward.heap.getMaxSize() + backward.heap.getMaxSize();
+        Frontier* frontiers[] = {&forward, &backward};
+        for (Frontier* f : frontiers)
+        {
+            addTableStats(stats, f->heap.getIndex());
+            addTableStats(stats, f->distTo);
+            addTableStats(stats, f->from);
+        }
+    }
+
+    // the frontiers have nothing left to do
+    void replayPath(bool found, ArrayList<Vector2I>& path) override
+    {
+        SearchEngine::replayPath(found, path);
+        stopped = true;
+    }
+
+    BidirectionalEngine()
+    {
+        best = NO_DISTANCE;
+        meetPos = Vector2I{.x = -1, .y = -1};
+        stopped = false;
+        forwardTurn = true;
+    }
+
+    void resetSearch() override
+    {
+        SearchEngine::resetSearch();
+        resetFrontier(forward, Vector2I{.x = -1, .y = -1}, targetPos);
+        resetFrontier(backward, Vector2I{.x = -1, .y = -1}, sourcePos);
+
+        best = NO_DISTANCE;
+        meetPos = Vector2I{.x = -1, .y = -1};
+        stopped = false;
+        forwardTurn = true;
+    }
+
+    void run() override
+    {
+        if ((long)width * height > DENSE_CELLS_LIMIT)
+        {
+            throw std::runtime_error("The map is too big for the bidirectional search");
+        }
+        forward.fit(width * height);
+        backward.fit(width * height);
+
+        resetSearch();
+        running = true;
+        currentPos = sourcePos;
+
+        from.insert(sourcePos, Vector2I{.x = -1000, .y = -1000});
+        resetFrontier(forward, sourcePos, targetPos);
+        resetFrontier(backward, targetPos, sourcePos);
+        countWork();
+    }
+
+    bool step() override
+    {
+        if (!running) return false;
+
+        if (!stopped)
+        {
+            Frontier& f = forwardTurn ? forward : backward;
+            Frontier& other = forwardTurn ? backward : forward;
+            forwardTurn = !forwardTurn;
+
+            // either frontier running out proves the best path is the shortest
+            if (!advance(f, other, true)) finish();
+            countWork();
+            return true;
+        }
+        return SearchEngine::step();
+    }
+
+    // the backward frontier gets its own thread, the calling one
+    // grows the forward frontier, the cells are not drawn
+    void solve() override
+    {
+        if (running && !stopped)
+        {
+            std::thread backwardThread([this]()
+            {
+                while (!stopped && advance(backward, forward, false)) {}
+                stopped = true;
+            });
+
+            while (!stopped && advance(forward, backward, false)) {}
+            stopped = true;
+
+            backwardThread.join();
+            finish();
+        }
+        SearchEngine::solve();
+    }
+};
+
+// lifelong planning A*, every reached cell keeps its distance (distTo) and
+// the best distance its neighbors offer (rhs), a cell whose two values
+// differ is inconsistent and waits in the heap
+// walls put or removed while the search runs only make the cells around
+// them inconsistent, so only the part of the search they change is redone
+class LPAStarEngine : public AStarEngine
+{
+
+private:
+    static const int NO_DISTANCE = 0x3FFFFFFF;
+
+    SearchTable<Vector2I, int> rhs;
+
+    // the cells drawn as PATH, they go back to CHECKED when the path changes
+    ArrayList<Vector2I> path;
+
+    int distanceOf(Vector2I pos)
+    {
+        int* distance = distTo.find(pos);
+        return distance == nullptr ? NO_DISTANCE : *distance;
+    }
+
+    int rhsOf(Vector2I pos)
+    {
+        if (pos == sourcePos) return 0;
+        int* distance = rhs.find(pos);
+        return distance == nullptr ? NO_DISTANCE : *distance;
+    }
+
+    OpenKey keyOf(Vector2I pos)
+    {
+        return std::min(distanceOf(pos), rhsOf(pos)) + heuristic(pos);
+    }
+
+    // recomputes the rhs of pos and puts it in the heap if it's inconsistent
+    void updateCell(Vector2I pos)
+    {
+        if (pos != sourcePos)
+        {
+            // moving is the same both ways, the corner rule looks at the same two cells
+            int best = NO_DISTANCE;
+            if (isFree(pos))
+            {
+                NeighborIterator<SearchEngine> iter;
+                iter.begin(*this, pos);
+                while (iter.hasNext())
+                {
+                    Vector2I newPos = iter.next();
+                    int distance = distanceOf(newPos);
+                    if (distance != NO_DISTANCE) best = std::min(best, distance + iter.getCost());
+                }
+            }
+            rhs.insert(pos, best);
+        }
+
+        if (heap.contains(pos)) heap.remove(pos);
+        if (distanceOf(pos) != rhsOf(pos))
+        {
+            heap.add(pos, keyOf(pos));
+            pushes += 1;
+            putToGrid(pos, CHECKED, now);
+        }
+    }
+
+    void updateNeighbors(Vector2I pos)
+    {
+        for (int y = -1; y <= 1; y += 1)
+        {
+            for (int x = -1; x <= 1; x += 1)
+            {
+                if (x == 0 && y == 0) continue;
+                Vector2I newPos = Vector2I{.x = pos.x + x, .y = pos.y + y};
+                if (!isValidCell(newPos)) continue;
+                generated += 1;
+                updateCell(newPos);
+            }
+        }
+    }
+
+    // the search is done once no inconsistent cell can change the target
+    bool isSettled()
+    {
+        if (heap.isEmpty()) return true;
+        return heap.getSmallestP() > keyOf(targetPos) && distanceOf(targetPos) == rhsOf(targetPos);
+    }
+
+    // walks down the distances from the target to rebuild from
+    void findPath()
+    {
+        from.clear();
+        for (Vector2I pos = targetPos; pos != sourcePos; )
+        {
+            Vector2I before = pos;
+            int best = NO_DISTANCE;
+            NeighborIterator<SearchEngine> iter;
+            iter.begin(*this, pos);
+            while (iter.hasNext())
+            {
+                Vector2I newPos = iter.next();
+                int distance = distanceOf(newPos);
+                if (distance != NO_DISTANCE && distance + iter.getCost() < best)
+                {
+                    best = distance + iter.getCost();
+                    before = newPos;
+                }
+            }
+            from.insert(pos, before);
+            pos = before;
+        }
+
+        pathFound = true;
+        currentPos = from.get(targetPos);
+    }
+
+    // the drawn path is no longer known to be the shortest
+    void erasePath()
+    {
+        for (int i = 0; i < path.getSize(); i += 1)
+        {
+            Vector2I pos = path.get(i);
+            if (typeAt(pos) == PATH) setCell(pos, {CHECKED, now});
+        }
+        path.clear();
+        pathFound = false;
+    }
+
+public:
+    const char* getName() override {return "lpastar";}
+
+    bool putToGrid(Vector2I key, CellType ct, double time) override
+    {
+        if (!running) return SearchEngine::putToGrid(key, ct, time);
+
+        // the endpoints stay where they are until the search is reset
+        if (ct == SOURCE || ct == TARGET) return false;
+
+        if (ct != WALL && ct != REMOVE)
+        {
+            bool put = SearchEngine::putToGrid(key, ct, time);
+            if (put && ct == PATH) path.push(key);
+            return put;
+        }
+
+        if (!isValidCell(key) || key == sourcePos || key == targetPos) return false;
+
+        if (ct == WALL)
+        {
+            if (typeAt(key) == WALL) return false;
+            setCell(key, {WALL, time});
+            wallsChanged(key);
+        }
+        else
+        {
+            if (typeAt(key) != WALL) return false;
+            removeWall(key);
+        }
+
+        // the cell itself and every move through or around it changed
+        erasePath();
+        updateCell(key);
+        updateNeighbors(key);
+        return false;
+    }
+
+    bool editsWhileRunning() override {return true;}
+
+    void resetSearch() override
+    {
+        AStarEngine::resetSearch();
+        rhs.clear();
+        path.clear();
+    }
+
+    void run() override
+    {
+        resetSearch();
+        running = true;
+        currentPos = sourcePos;
+
+        // the source is the only cell whose rhs is known at the start
+        heap.add(sourcePos, keyOf(sourcePos));
+        pushes += 1;
+    }
+
+    bool step() override
+    {
+        if (!running) return false;
+
+        if (!pathFound)
+        {
+            if (isSettled())
+            {
+                if (distanceOf(targetPos) == NO_DISTANCE) return false;
+                findPath();
+                return true;
+            }
+
+            currentPos = heap.removeSmallest();
+            expanded += 1;
+
+            if (distanceOf(currentPos) > rhsOf(currentPos))
+            {
+                distTo.insert(currentPos, rhsOf(currentPos));
+            }
+            else
+            {
+                distTo.insert(currentPos, NO_DISTANCE);
+                updateCell(currentPos);
+            }
+            updateNeighbors(currentPos);
+            return true;
+        }
+        return SearchEngine::step();
+    }
+};
+
+// hierarchical pathfinding (HPA*), the grid is cut into square clusters
+// and the free cells facing each other across a cluster border become
+// entrances, the distances between the entrances of every cluster are
+// kept, so a query searches the small graph of entrances and only then
+// finds the cells between them
+// the paths are close to the shortest but not always the shortest
+#define CLUSTER_SIZE 16
+#define CLUSTER_CELLS (CLUSTER_SIZE * CLUSTER_SIZE)
+// no cluster has more entrances than cells on its borders
+#define MAX_ENTRANCES (4 * CLUSTER_SIZE)
+// a border run this long gets an entrance at both ends
+#define WIDE_ENTRANCE 6
+
+class HPAStarEngine : public SearchEngine
+{
+
+private:
+    static const int NO_DISTANCE = 0x3FFFFFFF;
+
+    struct Cluster
+    {
+        Vector2I* entrances;
+        int size;
+
+        // the distance between entrances i and j is at i * size + j
+        int* distances;
+
+        // the walls of the cluster changed since it was built
+        bool dirty;
+    };
+
+    // the clusters cover the map row by row, they are allocated again
+    // when the map changes size
+    Cluster* clusters;
+    int clustersWide;
+    int clustersNumber;
+    int clusteredWidth;
+    int clusteredHeight;
+
+    // dijkstra inside one cluster, indexed by the place of the cell in it
+    BucketQueue<int> localQueue;
+    int localDistances[CLUSTER_CELLS];
+    int localParents[CLUSTER_CELLS];
+
+    // the distances from the source and the target inside their clusters
+    int sourceDistances[CLUSTER_CELLS];
+    int targetDistances[CLUSTER_CELLS];
+
+    // the search over the entrances, the source and the target are two
+    // more nodes after every entrance
+    BucketQueue<int> abstractOpen;
+    FlatHashtable<int, int> abstractDistTo;
+    FlatHashtable<int, int> abstractFrom;
+
+    int sourceNode() {return clustersNumber * MAX_ENTRANCES;}
+    int targetNode() {return sourceNode() + 1;}
+
+    int clusterOf(Vector2I pos)
+    {
+        return (pos.y / CLUSTER_SIZE) * clustersWide + pos.x / CLUSTER_SIZE;
+    }
+
+    Vector2I cornerOf(int cluster)
+    {
+        return Vector2I{.x = (cluster % clustersWide) * CLUSTER_SIZE, .y = (cluster / clustersWide) * CLUSTER_SIZE};
+    }
+
+    int localIndex(Vector2I pos)
+    {
+        return (pos.y % CLUSTER_SIZE) * CLUSTER_SIZE + pos.x % CLUSTER_SIZE;
+    }
+
+    Vector2I posOf(int node)
+    {
+        if (node == sourceNode()) return sourcePos;
+        if (node == targetNode()) return targetPos;
+        return clusters[node / MAX_ENTRANCES].entrances[node % MAX_ENTRANCES];
+    }
+
+    // the index of pos in the entrances of its cluster or -1
+    int entranceAt(Vector2I pos)
+    {
+        Cluster& cluster = clusters[clusterOf(pos)];
+        for (int i = 0; i < cluster.size; i += 1)
+        {
+            if (cluster.entrances[i] == pos) return i;
+        }
+        return -1;
+    }
+
+    int heuristic(Vector2I pos)
+    {
+        float dx = pos.x - targetPos.x;
+        float dy = pos.y - targetPos.y;
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    // dijkstra from start over the cells of its cluster,
+    // fills localDistances and localParents
+    void searchCluster(Vector2I start)
+    {
+        Vector2I corner = cornerOf(clusterOf(start));
+        for (int i = 0; i < CLUSTER_CELLS; i += 1) localDistances[i] = NO_DISTANCE;
+
+        localQueue.clear();
+        int startIndex = localIndex(start);
+        localDistances[startIndex] = 0;
+        localParents[startIndex] = startIndex;
+        localQueue.add(startIndex, 0);
+
+        while (!localQueue.isEmpty())
+        {
+            int index = localQueue.removeSmallest();
+            Vector2I pos = Vector2I{.x = corner.x + index % CLUSTER_SIZE, .y = corner.y + index / CLUSTER_SIZE};
+            expanded += 1;
+
+            NeighborIterator<SearchEngine> iter;
+            iter.begin(*this, pos);
+            while (iter.hasNext())
+            {
+                Vector2I newPos = iter.next();
+                if (newPos.x < corner.x || newPos.y < corner.y ||
+                    newPos.x >= corner.x + CLUSTER_SIZE || newPos.y >= corner.y + CLUSTER_SIZE) continue;
+                generated += 1;
+
+                int newIndex = localIndex(newPos);
+                int distance = localDistances[index] + iter.getCost();
+                if (distance >= localDistances[newIndex]) continue;
+
+                localParents[newIndex] = index;
+                if (localDistances[newIndex] == NO_DISTANCE)
+                {
+                    localQueue.add(newIndex, distance);
+                    pushes += 1;
+                }
+                else localQueue.decreaseKey(newIndex, distance);
+                localDistances[newIndex] = distance;
+            }
+        }
+    }
+
+    void addEntrance(Cluster& cluster, Vector2I pos)
+    {
+        for (int i = 0; i < cluster.size; i += 1)
+        {
+            if (cluster.entrances[i] == pos) return;
+        }
+        cluster.entrances[cluster.size] = pos;
+        cluster.size += 1;
+    }
+
+    // walks the border cells from first in the direction step, a cell is
+    // open when it and the cell across (at first + across) are free,
+    // every run of open cells gets one entrance or two if it's wide
+    void addBorderEntrances(Cluster& cluster, Vector2I first, Vector2I step, Vector2I across, int length)
+    {
+        int runStart = -1;
+        for (int i = 0; i <= length; i += 1)
+        {
+            Vector2I pos = Vector2I{.x = first.x + i * step.x, .y = first.y + i * step.y};
+            Vector2I other = Vector2I{.x = pos.x + across.x, .y = pos.y + across.y};
+            bool open = i < length && isFree(pos) && isFree(other);
+
+            if (open && runStart == -1) runStart = i;
+            if (open || runStart == -1) continue;
+
+            int runLength = i - runStart;
+            if (runLength < WIDE_ENTRANCE)
+            {
+                int middle = runStart + runLength / 2;
+                addEntrance(cluster, Vector2I{.x = first.x + middle * step.x, .y = first.y + middle * step.y});
+            }
+            else
+            {
+                addEntrance(cluster, Vector2I{.x = first.x + runStart * step.x, .y = first.y + runStart * step.y});
+                addEntrance(cluster, Vector2I{.x = first.x + (i - 1) * step.x, .y = first.y + (i - 1) * step.y});
+            }
+            runStart = -1;
+        }
+    }
+
+    // finds the entrances of a cluster and the distances between them,
+    // the clusters on both sides of a border pick the same rows or columns
+    void buildCluster(int index)
+    {
+        Cluster& cluster = clusters[index];
+        delete [] cluster.distances;
+        cluster.distances = nullptr;
+        cluster.size = 0;
+        cluster.dirty = false;
+
+        Vector2I corner = cornerOf(index);
+        int right = std::min(corner.x + CLUSTER_SIZE, width);
+        int bottom = std::min(corner.y + CLUSTER_SIZE, height);
+        if (corner.x >= width || corner.y >= height) return;
+
+        int columns = right - corner.x;
+        int rows = bottom - corner.y;
+
+        if (corner.x > 0)
+            addBorderEntrances(cluster, corner, Vector2I{.x = 0, .y = 1}, Vector2I{.x = -1, .y = 0}, rows);
+        if (right < width)
+            addBorderEntrances(cluster, Vector2I{.x = right - 1, .y = corner.y}, Vector2I{.x = 0, .y = 1}, Vector2I{.x = 1, .y = 0}, rows);
+        if (corner.y > 0)
+            addBorderEntrances(cluster, corner, Vector2I{.x = 1, .y = 0}, Vector2I{.x = 0, .y = -1}, columns);
+        if (bottom < height)
+            addBorderEntrances(cluster, Vector2I{.x = corner.x, .y = bottom - 1}, Vector2I{.x = 1, .y = 0}, Vector2I{.x = 0, .y = 1}, columns);
+
+        cluster.distances = new int[cluster.size * cluster.size];
+        for (int i = 0; i < cluster.size; i += 1)
+        {
+            searchCluster(cluster.entrances[i]);
+            for (int j = 0; j < cluster.size; j += 1)
+            {
+                cluster.distances[i * cluster.size + j] = localDistances[localIndex(cluster.entrances[j])];
+            }
+        }
+    }
+
+    // the clusters of another size are all built again anyway
+    bool isClustered()
+    {
+        return clusteredWidth == width && clusteredHeight == height;
+    }
+
+    void freeClusters()
+    {
+        for (int i = 0; i < clustersNumber; i += 1)
+        {
+            delete [] clusters[i].entrances;
+            delete [] clusters[i].distances;
+        }
+        delete [] clusters;
+        clusters = nullptr;
+        clustersNumber = 0;
+    }
+
+    void fitClusters()
+    {
+        if (isClustered()) return;
+        if ((long)width * height > DENSE_CELLS_LIMIT)
+        {
+            throw std::runtime_error("The map is too big for the hierarchical search");
+        }
+
+        freeClusters();
+        clustersWide = (width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        clustersNumber = clustersWide * ((height + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+        clusters = new Cluster[clustersNumber];
+        for (int i = 0; i < clustersNumber; i += 1)
+        {
+            clusters[i].entrances = new Vector2I[MAX_ENTRANCES];
+            clusters[i].distances = nullptr;
+            clusters[i].size = 0;
+            clusters[i].dirty = true;
+        }
+        clusteredWidth = width;
+        clusteredHeight = height;
+    }
+
+    void markDirty(Vector2I pos)
+    {
+        if (!isClustered()) return;
+        clusters[clusterOf(pos)].dirty = true;
+
+        // a border cell also changes the entrances of the cluster across
+        for (int i = 0; i < 4; i += 1)
+        {
+            Vector2I other = Vector2I{.x = pos.x + (i == 0) - (i == 1), .y = pos.y + (i == 2) - (i == 3)};
+            if (isValidCell(other)) clusters[clusterOf(other)].dirty = true;
+        }
+    }
+
+    void markAllDirty()
+    {
+        for (int i = 0; i < clustersNumber; i += 1) clusters[i].dirty = true;
+    }
+
+    // the building work isn't part of a query
+    void buildDirtyClusters()
+    {
+        int savedExpanded = expanded;
+        int savedGenerated = generated;
+        int savedPushes = pushes;
+        for (int i = 0; i < clustersNumber; i += 1)
+        {
+            if (clusters[i].dirty) buildCluster(i);
+        }
+        expanded = savedExpanded;
+        generated = savedGenerated;
+        pushes = savedPushes;
+    }
+
+    void addAbstractEdge(int node, int fromNode, int distance)
+    {
+        generated += 1;
+        int* oldDistance = abstractDistTo.find(node);
+        if (oldDistance == nullptr)
+        {
+            abstractDistTo.insert(node, distance);
+            abstractFrom.insert(node, fromNode);
+            abstractOpen.add(node, distance + heuristic(posOf(node)));
+            pushes += 1;
+        }
+        else if (distance < *oldDistance && abstractOpen.contains(node))
+        {
+            *oldDistance = distance;
+            abstractFrom.insert(node, fromNode);
+            abstractOpen.decreaseKey(node, distance + heuristic(posOf(node)));
+            decreases += 1;
+        }
+    }
+
+    void expandAbstract(int node)
+    {
+        int distance = abstractDistTo.get(node);
+        Vector2I pos = posOf(node);
+
+        if (node == sourceNode())
+        {
+            Cluster& cluster = clusters[clusterOf(sourcePos)];
+            int clusterIndex = clusterOf(sourcePos);
+            for (int j = 0; j < cluster.size; j += 1)
+            {
+                int d = sourceDistances[localIndex(cluster.entrances[j])];
+                if (d != NO_DISTANCE) addAbstractEdge(clusterIndex * MAX_ENTRANCES + j, node, d);
+            }
+            if (clusterOf(targetPos) == clusterIndex && sourceDistances[localIndex(targetPos)] != NO_DISTANCE)
+            {
+                addAbstractEdge(targetNode(), node, sourceDistances[localIndex(targetPos)]);
+            }
+            return;
+        }
+
+        int clusterIndex = node / MAX_ENTRANCES;
+        int i = node % MAX_ENTRANCES;
+        Cluster& cluster = clusters[clusterIndex];
+
+        for (int j = 0; j < cluster.size; j += 1)
+        {
+            int d = cluster.distances[i * cluster.size + j];
+            if (j != i && d != NO_DISTANCE) addAbstractEdge(clusterIndex * MAX_ENTRANCES + j, node, distance + d);
+        }
+
+        // the entrance facing this one across the border
+        for (int k = 0; k < 4; k += 1)
+        {
+            Vector2I other = Vector2I{.x = pos.x + (k == 0) - (k == 1), .y = pos.y + (k == 2) - (k == 3)};
+            if (!isFree(other) || clusterOf(other) == clusterIndex) continue;
+
+            int j = entranceAt(other);
+            if (j != -1) addAbstractEdge(clusterOf(other) * MAX_ENTRANCES + j, node, distance + edgeCost(other, pos));
+        }
+
+        if (clusterOf(targetPos) == clusterIndex && targetDistances[localIndex(pos)] != NO_DISTANCE)
+        {
+            addAbstractEdge(targetNode(), node, distance + targetDistances[localIndex(pos)]);
+        }
+    }
+
+    // turns the entrances of the found path into cells and puts them in from
+    void refinePath()
+    {
+        ArrayList<int> nodes;
+        for (int node = targetNode(); node != sourceNode(); node = abstractFrom.get(node)) nodes.push(node);
+        int source = sourceNode();
+        nodes.push(source);
+
+        // the cells from the source to the target
+        ArrayList<Vector2I> cells;
+        cells.push(sourcePos);
+        for (int i = nodes.getSize() - 1; i > 0; i -= 1)
+        {
+            Vector2I start = posOf(nodes.get(i));
+            Vector2I end = posOf(nodes.get(i - 1));
+            if (start == end) continue;
+
+            if (clusterOf(start) != clusterOf(end))
+            {
+                cells.push(end);
+                continue;
+            }
+
+            // the parents lead back from end to start
+            searchCluster(start);
+            ArrayList<Vector2I> part;
+            Vector2I corner = cornerOf(clusterOf(start));
+            for (int index = localIndex(end); index != localIndex(start); index = localParents[index])
+            {
+                Vector2I pos = Vector2I{.x = corner.x + index % CLUSTER_SIZE, .y = corner.y + index / CLUSTER_SIZE};
+                part.push(pos);
+            }
+            for (int j = part.getSize() - 1; j >= 0; j -= 1) cells.push(part.get(j));
+        }
+
+        // a cell met twice means the path loops, the loop is cut out
+        FlatHashtable<Vector2I, int> places;
+        ArrayList<Vector2I> path;
+        for (int i = 0; i < cells.getSize(); i += 1)
+        {
+            Vector2I pos = cells.get(i);
+            int* place = places.find(pos);
+            if (place != nullptr)
+            {
+                while (path.getSize() > *place + 1) places.remove(path.pop());
+                continue;
+            }
+            places.insert(pos, path.getSize());
+            path.push(pos);
+        }
+
+        from.clear();
+        for (int i = 1; i < path.getSize(); i += 1) from.insert(path.get(i), path.get(i - 1));
+
+        pathFound = true;
+        currentPos = from.get(targetPos);
+    }
+
+protected:
+    // only the clusters around changed walls are built again
+    void onWallsChanged(Vector2I key) override
+    {
+        if (key == ALL_CELLS) markAllDirty();
+        else markDirty(key);
+    }
+
+public:
+    const char* getName() override {return "hpastar";}
+
+    HPAStarEngine()
+    {
+        clusters = nullptr;
+        clustersWide = 0;
+        clustersNumber = 0;
+        clusteredWidth = 0;
+        clusteredHeight = 0;
+    }
+    ~HPAStarEngine()
+    {
+        freeClusters();
+    }
+
+
+    // the open list is the one of the entrances, the tables of the
+    // refined path are counted with theirs
+    void getStats(SearchStats& stats) override
+    {
+        SearchEngine::getStats(stats);
+        stats.maxOpenSize = abstractOpen.getMaxSize();
+        addTableStats(stats, abstractOpen.getIndex());
+        addTableStats(stats, abstractDistTo);
+        addTableStats(stats, abstractFrom);
+    }
+
+    void resetSearch() override
+    {
+        SearchEngine::resetSearch();
+        abstractOpen.clear();
+        abstractDistTo.clear();
+        abstractFrom.clear();
+    }
+
+    void run() override
+    {
+        fitClusters();
+        resetSearch();
+        buildDirtyClusters();
+
+        running = true;
+        currentPos = sourcePos;
+        if (!isValidCell(sourcePos) || !isValidCell(targetPos)) return;
+
+        searchCluster(sourcePos);
+        for (int i = 0; i < CLUSTER_CELLS; i += 1) sourceDistances[i] = localDistances[i];
+        searchCluster(targetPos);
+        for (int i = 0; i < CLUSTER_CELLS; i += 1) targetDistances[i] = localDistances[i];
+
+        int source = sourceNode();
+        abstractDistTo.insert(source, 0);
+        abstractOpen.add(source, heuristic(sourcePos));
+        pushes += 1;
+    }
+
+    // one step expands one entrance
+    bool step() override
+    {
+        if (!running) return false;
+
+        if (!pathFound)
+        {
+            if (abstractOpen.isEmpty()) return false;
+
+            int node = abstractOpen.removeSmallest();
+            expanded += 1;
+            currentPos = posOf(node);
+
+            if (node == targetNode())
+            {
+                refinePath();
+                return true;
+            }
+
+            putToGrid(currentPos, CHECKED, now);
+            expandAbstract(node);
+            return true;
+        }
+        return SearchEngine::step();
+    }
+};
+
+#endif
\ No newline at end of file
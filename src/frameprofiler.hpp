@@ -0,0 +1,161 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+
+#include "../data_structures/ringbuffer.hpp"
+
+// times the parts of every frame, every zone timed is kept as a record of
+// when it started and how long it took, the records and the per frame
+// totals go to rings so the last frames can always be looked at without
+// anything growing
+// the drawing zones only time the calls queueing the drawing, the gpu
+// does it later, mostly while EndDrawing waits
+
+// the zone records kept, a frame makes one for every zone it times
+#define PROFILE_RECORDS (1 << 14)
+// the frames whose zone totals are kept
+#define PROFILE_FRAMES 512
+
+enum ProfileZone
+{
+    FRAME_ZONE = 0, INPUT_ZONE, UPDATE_ZONE, CELLS_ZONE, LINES_ZONE, OVERLAY_ZONE, PRESENT_ZONE,
+};
+#define PROFILE_ZONES 7
+
+const char* const ZONE_NAMES[] = {"frame", "input", "update", "cells", "lines", "overlay", "present",};
+
+// the times are in nanoseconds since the profiler was made
+struct ZoneRecord
+{
+    int zone;
+    int frame;
+    int64_t start;
+    int64_t duration;
+};
+
+// the time every zone took in one frame, 0 for the zones it didn't time
+struct FrameTimes
+{
+    int64_t zones[PROFILE_ZONES];
+};
+
+class FrameProfiler
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point origin;
+
+    RingBuffer<ZoneRecord> records;
+    RingBuffer<FrameTimes> frames;
+
+    FrameTimes current;
+    int frame;
+    // when every zone open now started
+    int64_t started[PROFILE_ZONES];
+
+public:
+    FrameProfiler() : records(PROFILE_RECORDS), frames(PROFILE_FRAMES)
+    {
+        origin = Clock::now();
+        frame = 0;
+        for (int i = 0; i < PROFILE_ZONES; i += 1)
+        {
+            started[i] = 0;
+            current.zones[i] = 0;
+        }
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+    }
+
+    void begin(ProfileZone zone)
+    {
+        started[zone] = now();
+    }
+
+    // a zone timed twice in a frame adds up in its total
+    void end(ProfileZone zone)
+    {
+        int64_t duration = now() - started[zone];
+        records.push(ZoneRecord{.zone = zone, .frame = frame, .start = started[zone], .duration = duration});
+        current.zones[zone] += duration;
+    }
+
+    void beginFrame()
+    {
+        for (int i = 0; i < PROFILE_ZONES; i += 1) current.zones[i] = 0;
+        begin(FRAME_ZONE);
+    }
+
+    void endFrame()
+    {
+        end(FRAME_ZONE);
+        frames.push(current);
+        frame += 1;
+    }
+
+    // the zone totals of the last frames ended, the oldest first
+    RingBuffer<FrameTimes>& getFrames() {return frames;}
+
+    // one line for every record kept, the oldest first
+    void writeCsv(std::ostream& out)
+    {
+        out << "zone,frame,start_ns,duration_ns" << std::endl;
+        for (int i = 0; i < records.getSize(); i += 1)
+        {
+            ZoneRecord& r = records.get(i);
+            out << ZONE_NAMES[r.zone] << "," << r.frame << "," << r.start << "," << r.duration << std::endl;
+        }
+    }
+
+    // the records as complete events of the chrome trace format, the
+    // zones of a frame show nested in it
+    void writeTrace(std::ostream& out)
+    {
+        // the times are in microseconds, with the nanoseconds kept as decimals
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\": [" << std::endl;
+        for (int i = 0; i < records.getSize(); i += 1)
+        {
+            ZoneRecord& r = records.get(i);
+            out << "  {\"name\": \"" << ZONE_NAMES[r.zone] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+                << ", \"ts\": " << r.start / 1e3 << ", \"dur\": " << r.duration / 1e3
+                << ", \"args\": {\"frame\": " << r.frame << "}}"
+                << (i + 1 < records.getSize() ? "," : "") << std::endl;
+        }
+        out << "], \"displayTimeUnit\": \"ns\"}" << std::endl;
+    }
+};
+
+// times a zone from its creation to the end of its scope
+class ScopedZone
+{
+private:
+    FrameProfiler& profiler;
+    ProfileZone zone;
+
+public:
+    ScopedZone(FrameProfiler& frameProfiler, ProfileZone profileZone) : profiler(frameProfiler), zone(profileZone)
+    {
+        profiler.begin(zone);
+    }
+    ~ScopedZone()
+    {
+        profiler.end(zone);
+    }
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+};
+
+#endif
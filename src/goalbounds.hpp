@@ -0,0 +1,264 @@
+#ifndef GOAL_BOUNDS_H
+#define GOAL_BOUNDS_H
+
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+#include "../data_structures/bucketqueue.hpp"
+
+#include "./batch.hpp"
+#include "./cpd.hpp"
+#include "./engine.hpp"
+
+// the longest side of a map the boxes can hold
+#define BOX_SIDE_LIMIT UINT16_MAX
+
+// goal bounding, for every cell and every move out of it the bounding box
+// of the targets whose shortest path starts with that move is kept
+// a search never needs a move whose box doesn't hold the target
+
+class GoalBounds
+{
+private:
+    // an empty box has its minimum past its maximum, the coordinates
+    // take 16 bits so no side of the map can be longer than BOX_SIDE_LIMIT
+    struct Box
+    {
+        uint16_t minX;
+        uint16_t minY;
+        uint16_t maxX;
+        uint16_t maxY;
+    };
+
+    // the 8 boxes of a cell are next to each other
+    Box* boxes;
+    int width;
+    int height;
+
+    // the walls the boxes were built on
+    uint64_t wallsHash;
+
+    // the sources are handed out one at a time to the building threads
+    std::atomic<int> nextSource;
+
+    // grows the boxes of every source handed to this thread
+    // every source only writes its own boxes
+    void buildBoxes(GridSnapshot* grid)
+    {
+        BucketQueue<int> heap;
+        int* distTo = new int[width * height];
+        unsigned char* firstMove = new unsigned char[width * height];
+
+        for (int source = nextSource.fetch_add(1); source < width * height; source = nextSource.fetch_add(1))
+        {
+            if (!grid->isFree(Vector2I{.x = source % width, .y = source / width})) continue;
+
+            mapDistances(*grid, heap, source, distTo, firstMove);
+
+            Box* cellBoxes = &boxes[source * 8];
+            for (int target = 0; target < width * height; target += 1)
+            {
+                if (target == source || distTo[target] == -1) continue;
+
+                Box& box = cellBoxes[firstMove[target]];
+                uint16_t x = target % width;
+                uint16_t y = target / width;
+                box.minX = std::min(box.minX, x);
+                box.minY = std::min(box.minY, y);
+                box.maxX = std::max(box.maxX, x);
+                box.maxY = std::max(box.maxY, y);
+            }
+        }
+
+        delete [] distTo;
+        delete [] firstMove;
+    }
+
+public:
+    GoalBounds()
+    {
+        boxes = nullptr;
+        width = 0;
+        height = 0;
+        wallsHash = 0;
+    }
+    ~GoalBounds()
+    {
+        delete [] boxes;
+    }
+
+    GoalBounds(const GoalBounds&) = delete;
+    GoalBounds& operator=(const GoalBounds&) = delete;
+
+    bool isBuilt() {return boxes != nullptr;}
+
+    // true if the boxes were built on the same walls as the engine has now
+    bool matches(SearchEngine& engine)
+    {
+        GridSnapshot grid;
+        grid.freeze(engine);
+        return isBuilt() && grid.hash() == wallsHash;
+    }
+
+    // one dijkstra from every free cell of the engine, the sources are
+    // spread over the threads, zero threads means one per core
+    void build(SearchEngine& engine, int threadsCount = 0)
+    {
+        GridSnapshot grid;
+        grid.freeze(engine);
+
+        if (grid.getWidth() > BOX_SIDE_LIMIT || grid.getHeight() > BOX_SIDE_LIMIT)
+        {
+            throw std::runtime_error("The map is too wide for the goal bounds");
+        }
+
+        width = grid.getWidth();
+        height = grid.getHeight();
+        wallsHash = grid.hash();
+
+        delete [] boxes;
+        boxes = new Box[width * height * 8];
+        for (int i = 0; i < width * height * 8; i += 1) boxes[i] = Box{0xFFFF, 0xFFFF, 0, 0};
+
+        int threadsNumber = threadsCount > 0 ? threadsCount : std::thread::hardware_concurrency();
+        if (threadsNumber <= 0) threadsNumber = 1;
+
+        nextSource = 0;
+        std::thread* threads = new std::thread[threadsNumber];
+        for (int i = 0; i < threadsNumber; i += 1)
+        {
+            threads[i] = std::thread(&GoalBounds::buildBoxes, this, &grid);
+        }
+        for (int i = 0; i < threadsNumber; i += 1) threads[i].join();
+        delete [] threads;
+    }
+
+    // the file is a "GB01" tag, the width, the height, the walls hash
+    // and the boxes, in the byte order of the machine saving it, a file
+    // is only read back on the same kind
+    bool save(const char* path)
+    {
+        if (!isBuilt()) return false;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        file.write("GB01", 4);
+        file.write((const char*)&width, sizeof(width));
+        file.write((const char*)&height, sizeof(height));
+        file.write((const char*)&wallsHash, sizeof(wallsHash));
+        file.write((const char*)boxes, sizeof(Box) * width * height * 8);
+        return (bool)file;
+    }
+
+    bool load(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        char tag[4];
+        file.read(tag, 4);
+        if (!file || memcmp(tag, "GB01", 4) != 0) return false;
+
+        delete [] boxes;
+        boxes = nullptr;
+        file.read((char*)&width, sizeof(width));
+        file.read((char*)&height, sizeof(height));
+        file.read((char*)&wallsHash, sizeof(wallsHash));
+        if (!file || width <= 0 || height <= 0 || width > BOX_SIDE_LIMIT || height > BOX_SIDE_LIMIT ||
+                (long)width * height > DENSE_CELLS_LIMIT)
+        {
+            return false;
+        }
+
+        // the rest of the file has to be the boxes exactly, so a broken
+        // header can't ask for more than the file holds
+        std::streampos start = file.tellg();
+        file.seekg(0, std::ios::end);
+        long rest = (long)(file.tellg() - start);
+        file.seekg(start);
+        if (rest != (long)sizeof(Box) * width * height * 8) return false;
+
+        boxes = new Box[width * height * 8];
+        file.read((char*)boxes, sizeof(Box) * width * height * 8);
+        if (!file)
+        {
+            delete [] boxes;
+            boxes = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // true if the move from pos may start a shortest path to target
+    bool allows(Vector2I pos, int move, Vector2I target)
+    {
+        if (pos.x >= width || pos.y >= height) return true;
+
+        Box& box = boxes[(pos.y * width + pos.x) * 8 + move];
+        return target.x >= box.minX && target.x <= box.maxX &&
+                target.y >= box.minY && target.y <= box.maxY;
+    }
+};
+
+// A* that skips the moves whose box doesn't hold the target, the boxes
+// are built again when the walls have changed since they were built or loaded
+class GoalBoundingEngine : public AStarEngine
+{
+
+private:
+    GoalBounds bounds;
+    bool stale;
+
+protected:
+    bool prunes(Vector2I pos, int x, int y) override
+    {
+        int move = moveOf(x, y);
+        return move == -1 || !bounds.allows(pos, move, targetPos);
+    }
+
+    void onWallsChanged(Vector2I) override
+    {
+        stale = true;
+    }
+
+public:
+    const char* getName() override {return "goalbounds";}
+
+    GoalBoundingEngine()
+    {
+        stale = true;
+    }
+
+    // the offline step, zero threads means one per core
+    void buildBounds(int threadsCount = 0)
+    {
+        bounds.build(*this, threadsCount);
+        stale = false;
+    }
+
+    // uses saved boxes if they were built on the current walls
+    bool loadBounds(const char* path)
+    {
+        if (!bounds.load(path) || !bounds.matches(*this)) return false;
+        stale = false;
+        return true;
+    }
+
+    bool saveBounds(const char* path)
+    {
+        return bounds.save(path);
+    }
+
+    void run() override
+    {
+        if (stale) buildBounds();
+        AStarEngine::run();
+    }
+};
+
+#endif
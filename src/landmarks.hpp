@@ -0,0 +1,188 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <math.h>
+#include <stdint.h>
+#include <thread>
+
+#include "./batch.hpp"
+#include "./engine.hpp"
+
+// the ALT heuristic (A*, landmarks and the triangle inequality)
+// the distances from a few landmark cells to every cell are kept, and for
+// any landmark L, |d(L, target) - d(L, v)| never overestimates d(v, target)
+
+#define LANDMARKS_NUMBER 8
+
+class Landmarks
+{
+private:
+    // distances that don't fit in 16 bits are not known
+    static const uint16_t UNKNOWN = 0xFFFF;
+
+    // the distances of a cell from every landmark are next to each other,
+    // so a lookup touches one cache line
+    uint16_t* distances;
+    int width;
+    int height;
+
+    Vector2I landmarks[LANDMARKS_NUMBER];
+    int landmarksNumber;
+
+    // the walls changed since the distances were found
+    bool stale;
+
+    // dijkstra from landmark over the whole snapshot, run on its own thread
+    // with its own bucket queue and distances
+    void mapLandmark(GridSnapshot* grid, int landmark)
+    {
+        BucketQueue<int> heap;
+        int* distTo = new int[width * height];
+        mapDistances(*grid, heap, landmarks[landmark].y * width + landmarks[landmark].x, distTo);
+
+        for (int i = 0; i < width * height; i += 1)
+        {
+            if (distTo[i] == -1) continue;
+            distances[i * landmarksNumber + landmark] = distTo[i] < UNKNOWN ? distTo[i] : UNKNOWN;
+        }
+        delete [] distTo;
+    }
+
+    // the landmarks are spread around the edge of the map, each is the
+    // free cell closest to the edge on its own ray from the center
+    void pickLandmarks(GridSnapshot& grid)
+    {
+        landmarksNumber = 0;
+        float centerX = (width - 1) / 2.0f;
+        float centerY = (height - 1) / 2.0f;
+
+        for (int i = 0; i < LANDMARKS_NUMBER; i += 1)
+        {
+            float angle = 2 * M_PI * i / LANDMARKS_NUMBER;
+            float dx = cos(angle);
+            float dy = sin(angle);
+
+            // how far the ray goes before leaving the map
+            float reach = std::min(fabs(dx) > 1e-6 ? centerX / fabs(dx) : width, fabs(dy) > 1e-6 ? centerY / fabs(dy) : height);
+
+            for (float t = reach; t >= 0; t -= 1)
+            {
+                Vector2I pos = Vector2I{.x = (int)round(centerX + t * dx), .y = (int)round(centerY + t * dy)};
+                if (!grid.isFree(pos)) continue;
+
+                bool picked = false;
+                for (int j = 0; j < landmarksNumber; j += 1) picked = picked || landmarks[j] == pos;
+                if (!picked)
+                {
+                    landmarks[landmarksNumber] = pos;
+                    landmarksNumber += 1;
+                }
+                break;
+            }
+        }
+    }
+
+public:
+    Landmarks()
+    {
+        distances = nullptr;
+        width = 0;
+        height = 0;
+        landmarksNumber = 0;
+        stale = true;
+    }
+    ~Landmarks()
+    {
+        delete [] distances;
+    }
+
+    Landmarks(const Landmarks&) = delete;
+    Landmarks& operator=(const Landmarks&) = delete;
+
+    // a stale table bounds nothing, the next query finds the distances again
+    bool isStale() {return stale;}
+    void setStale(bool s) {stale = s;}
+
+    // picks the landmarks on the walls of the engine and maps the
+    // distances from all of them at once, one thread for each where
+    // there are threads
+    void build(SearchEngine& engine)
+    {
+        GridSnapshot grid;
+        grid.freeze(engine);
+
+        width = grid.getWidth();
+        height = grid.getHeight();
+        pickLandmarks(grid);
+
+        delete [] distances;
+        distances = new uint16_t[width * height * landmarksNumber];
+        for (int i = 0; i < width * height * landmarksNumber; i += 1) distances[i] = UNKNOWN;
+
+    #if defined(PLATFORM_WEB)
+        // no threads here, the landmarks are mapped one after another
+        for (int i = 0; i < landmarksNumber; i += 1) mapLandmark(&grid, i);
+    #else
+        std::thread threads[LANDMARKS_NUMBER];
+        for (int i = 0; i < landmarksNumber; i += 1)
+        {
+            threads[i] = std::thread(&Landmarks::mapLandmark, this, &grid, i);
+        }
+        for (int i = 0; i < landmarksNumber; i += 1) threads[i].join();
+    #endif
+
+        stale = false;
+    }
+
+    // the largest lower bound of the distance between pos and target
+    int bound(Vector2I pos, Vector2I target)
+    {
+        if (stale || pos.x >= width || pos.y >= height || target.x >= width || target.y >= height) return 0;
+
+        uint16_t* fromPos = &distances[(pos.y * width + pos.x) * landmarksNumber];
+        uint16_t* fromTarget = &distances[(target.y * width + target.x) * landmarksNumber];
+
+        int best = 0;
+        for (int i = 0; i < landmarksNumber; i += 1)
+        {
+            if (fromPos[i] == UNKNOWN || fromTarget[i] == UNKNOWN) continue;
+            best = std::max(best, abs(fromPos[i] - fromTarget[i]));
+        }
+        return best;
+    }
+
+    int getLandmarksNumber() {return landmarksNumber;}
+    Vector2I getLandmark(int i) {return landmarks[i];}
+};
+
+// A* with the larger of the euclidean and the landmark bounds
+class ALTEngine : public AStarEngine
+{
+
+private:
+    Landmarks landmarks;
+
+protected:
+    float heuristic(Vector2I vertex) override
+    {
+        return std::max(AStarEngine::heuristic(vertex), (float)landmarks.bound(vertex, targetPos));
+    }
+
+    // a changed wall makes the distances wrong, they are found again
+    // before the next search
+    void onWallsChanged(Vector2I) override
+    {
+        landmarks.setStale(true);
+    }
+
+public:
+    const char* getName() override {return "alt";}
+
+    void run() override
+    {
+        if (landmarks.isStale()) landmarks.build(*this);
+        AStarEngine::run();
+    }
+};
+
+#endif
@@ -1,7 +1,11 @@
+#include <fstream>
+
 #include "../include/raylib/src/raylib.h"
 
 #include "./searchers.hpp"
+#include "./canvas.hpp"
 #include "./controls.hpp"
+#include "./frameprofiler.hpp"
 
 
 #if defined(PLATFORM_WEB)
@@ -12,8 +16,8 @@
 #define STANDARD_HEIGHT 1728.0f
 #define FRAMES 60.0f
 #define SCREEN_PARTS 10.0f
-#define CONTROL_BUTTONS_NUMBER 7
-#define ALGORITHM_BUTTONS_NUMBER 4
+#define CONTROL_BUTTONS_NUMBER 8
+#define ALGORITHM_BUTTONS_NUMBER 9
 #define FONT_SIZE_RATIO FONT_SIZE / STANDARD_WIDTH
 #define BUTTON_WIDTH_RATIO 230.0f / STANDARD_WIDTH
 #define BUTTON_HEIGHT_RATIO 60.0f / STANDARD_HEIGHT
@@ -26,33 +30,73 @@
 #define TARGET_CONTROL 4
 #define WALL_CONTROL 5
 #define REMOVE_CONTROL 6
+#define SPEED_CONTROL 7
 
 
 #define ALGORITHMS 0
 #define DIJKSTRA 1
 #define ASTAR 2
 #define GREEDY_BFS 3
+#define JUMP_POINT 4
+#define BIDIRECTIONAL 5
+#define LIFELONG_ASTAR 6
+#define HIERARCHICAL_ASTAR 7
+#define LANDMARK_ASTAR 8
 
 #define LINE_COLOR ColorAlpha(BLACK, 0.2)
 
+// the key showing the work of the search over the grid, and the key adding
+// it to the stats file, one json object for every line
+#define STATS_KEY KEY_I
+#define STATS_DUMP_KEY KEY_J
+#define STATS_FILE "search_stats.jsonl"
+#define STATS_LINES 7
+#define STATS_COLOR ColorAlpha(WHITE, 0.85)
+
+// the key showing the time of the last frames by zone, and the key writing
+// the zones kept to a csv file and a chrome trace (chrome://tracing)
+#define PROFILE_KEY KEY_P
+#define PROFILE_DUMP_KEY KEY_O
+#define PROFILE_CSV_FILE "frame_profile.csv"
+#define PROFILE_TRACE_FILE "frame_profile.json"
+// the frames the graph shows, a frame at the target rate is half its height
+#define PROFILE_GRAPH_FRAMES 240
+
 float screenWidth = STANDARD_WIDTH;
 float screenHeight = STANDARD_HEIGHT;
 
 
 static int searcherType = DIJKSTRA;
 static Searcher* searcher;
-static Hashtable<Vector2I, Cell>::HashIterator iter;
+static PathCache pathCache;
+static GridCanvas canvas(0);
+// drawn instead of the canvas when the cells are too small to see one by one
+static GridCanvas blockCanvas(BLOCK_BITS);
 
 Button controlButtons[CONTROL_BUTTONS_NUMBER];
-static const char* controlButtonsText[] = {"CONTROLS: ", "START", "CLEAR", "SOURCE", "TARGET", "WALL", "REMOVE"};
-static const Color controlButtonsColor[] = {WHITE, GREEN, LIGHTGRAY, SOURCE_COLOR, TARGET_COLOR, WALL_COLOR, RED};
+static const char* controlButtonsText[] = {"CONTROLS: ", "START", "CLEAR", "SOURCE", "TARGET", "WALL", "REMOVE", "SPEED: 1K"};
+static const Color controlButtonsColor[] = {WHITE, GREEN, LIGHTGRAY, SOURCE_COLOR, TARGET_COLOR, WALL_COLOR, RED, SKYBLUE};
+
+// the most cells a search shows every frame, the speed button goes through
+// them, MAX shows what fits the frame and INSTANT searches before showing
+#define SPEEDS_NUMBER 5
+#define INSTANT_SPEED 4
+static const int playbackRates[] = {100, DEFAULT_PLAYBACK_RATE, 10000, 0, 0};
+static const char* speedsText[] = {"SPEED: 100", "SPEED: 1K", "SPEED: 10K", "SPEED: MAX", "INSTANT"};
+static int speed = 1;
 
 static Button algorithmButtons[ALGORITHM_BUTTONS_NUMBER];
-static const char* algorithmButtonsText[] = {"ALGORITHMS: ", "DIJKSTRA", "ASTAR", "BFS"};
-static const Color algorithmButtonsColor[] = {WHITE, PURPLE, YELLOW, MAROON};
+static const char* algorithmButtonsText[] = {"ALGORITHMS: ", "DIJKSTRA", "ASTAR", "BFS", "JPS", "BI-ASTAR", "LPASTAR", "HPASTAR", "ALT"};
+static const Color algorithmButtonsColor[] = {WHITE, PURPLE, YELLOW, MAROON, DARKGREEN, ORANGE, VIOLET, GOLD, LIME};
 
 static int currentControl;
 static int currentAlgorithm;
+static bool showStats = false;
+
+static FrameProfiler profiler;
+static bool showProfile = false;
+// the zones stacked in the graph, the time EndDrawing waits is on top
+static const Color zoneColors[] = {BLACK, SKYBLUE, ORANGE, DARKGREEN, PURPLE, MAROON, GRAY};
 
 void selectSearcherType(int type)
 {
@@ -76,6 +120,36 @@ void selectSearcherType(int type)
         searcher = new BFS(oldSearcher);
         delete oldSearcher;
     }
+    else if (searcherType == JUMP_POINT)
+    {
+        Searcher* oldSearcher = searcher;
+        searcher = new JPS(oldSearcher);
+        delete oldSearcher;
+    }
+    else if (searcherType == BIDIRECTIONAL)
+    {
+        Searcher* oldSearcher = searcher;
+        searcher = new Bidirectional(oldSearcher);
+        delete oldSearcher;
+    }
+    else if (searcherType == LIFELONG_ASTAR)
+    {
+        Searcher* oldSearcher = searcher;
+        searcher = new LPAStar(oldSearcher);
+        delete oldSearcher;
+    }
+    else if (searcherType == HIERARCHICAL_ASTAR)
+    {
+        Searcher* oldSearcher = searcher;
+        searcher = new HPAStar(oldSearcher);
+        delete oldSearcher;
+    }
+    else if (searcherType == LANDMARK_ASTAR)
+    {
+        Searcher* oldSearcher = searcher;
+        searcher = new ALT(oldSearcher);
+        delete oldSearcher;
+    }
 }
 
 
@@ -115,6 +189,13 @@ void updateButtons(Vector2 mouse, bool isPressed)
         searcher->select(REMOVE);
         currentControl = REMOVE_CONTROL;
     }
+    if (controlButtons[SPEED_CONTROL].updateState(mouse, isPressed, false))
+    {
+        speed = (speed + 1) % SPEEDS_NUMBER;
+        searcher->setPlaybackRate(playbackRates[speed]);
+        searcher->setInstant(speed == INSTANT_SPEED);
+        controlButtons[SPEED_CONTROL].setText(speedsText[speed]);
+    }
     if (algorithmButtons[DIJKSTRA].updateState(mouse, isPressed, currentAlgorithm == DIJKSTRA))
     {
         selectSearcherType(DIJKSTRA);
@@ -130,6 +211,31 @@ void updateButtons(Vector2 mouse, bool isPressed)
         selectSearcherType(GREEDY_BFS);
         currentAlgorithm = GREEDY_BFS;
     }
+    if (algorithmButtons[JUMP_POINT].updateState(mouse, isPressed, currentAlgorithm == JUMP_POINT))
+    {
+        selectSearcherType(JUMP_POINT);
+        currentAlgorithm = JUMP_POINT;
+    }
+    if (algorithmButtons[BIDIRECTIONAL].updateState(mouse, isPressed, currentAlgorithm == BIDIRECTIONAL))
+    {
+        selectSearcherType(BIDIRECTIONAL);
+        currentAlgorithm = BIDIRECTIONAL;
+    }
+    if (algorithmButtons[LIFELONG_ASTAR].updateState(mouse, isPressed, currentAlgorithm == LIFELONG_ASTAR))
+    {
+        selectSearcherType(LIFELONG_ASTAR);
+        currentAlgorithm = LIFELONG_ASTAR;
+    }
+    if (algorithmButtons[HIERARCHICAL_ASTAR].updateState(mouse, isPressed, currentAlgorithm == HIERARCHICAL_ASTAR))
+    {
+        selectSearcherType(HIERARCHICAL_ASTAR);
+        currentAlgorithm = HIERARCHICAL_ASTAR;
+    }
+    if (algorithmButtons[LANDMARK_ASTAR].updateState(mouse, isPressed, currentAlgorithm == LANDMARK_ASTAR))
+    {
+        selectSearcherType(LANDMARK_ASTAR);
+        currentAlgorithm = LANDMARK_ASTAR;
+    }
 }
 
 void initButtons()
@@ -178,22 +284,116 @@ void initButtons()
 }
 
 
+// the work of the search shown, over the bottom left corner of the grid
+void drawStats()
+{
+    SearchStats stats;
+    searcher->getStats(stats);
+
+    float fontSize = FONT_SIZE_RATIO * screenWidth;
+    Rectangle area = searcher->getGridArea();
+    float x = area.x + fontSize;
+    float y = area.y + area.height - (STATS_LINES + 1) * fontSize;
+    DrawRectangle(x - fontSize / 2, y - fontSize / 2, 24 * fontSize, (STATS_LINES + 0.5f) * fontSize, STATS_COLOR);
+
+    const char* state = stats.pathFound ? "found" : searcher->isRunning() ? "searching" : "none";
+    DrawText(TextFormat("%s, path: %s, cost: %d", stats.algorithm, state, stats.pathCost), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("expanded: %d, generated: %d", stats.expanded, stats.generated), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("pushes: %d, pops: %d, decreases: %d", stats.pushes, stats.pops, stats.decreases), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("open list size: %d at most", stats.maxOpenSize), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("probes: %ld, rehashes: %d, longest bucket: %d", stats.probes, stats.rehashes, stats.longestBucket), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("list resizes: %ld", stats.listResizes), x, y, fontSize, BLACK);
+    y += fontSize;
+    DrawText(TextFormat("ms: setup %.2f, search %.2f, path %.2f", stats.phaseSeconds[SETUP_PHASE] * 1e3,
+        stats.phaseSeconds[SEARCH_PHASE] * 1e3, stats.phaseSeconds[PATH_PHASE] * 1e3), x, y, fontSize, BLACK);
+}
+
+// adds the stats of the search shown to STATS_FILE
+void dumpStats()
+{
+    SearchStats stats;
+    searcher->getStats(stats);
+
+    std::ofstream out(STATS_FILE, std::ios::app);
+    if (!out)
+    {
+        TraceLog(LOG_WARNING, "can not write the stats to %s", STATS_FILE);
+        return;
+    }
+    writeStatsJson(out, stats);
+}
+
+// the zones of the last frames as stacked bars, over the bottom right corner of the grid
+void drawProfile()
+{
+    RingBuffer<FrameTimes>& frames = profiler.getFrames();
+
+    float fontSize = FONT_SIZE_RATIO * screenWidth;
+    Rectangle area = searcher->getGridArea();
+    float barWidth = fontSize / 8;
+    float width = PROFILE_GRAPH_FRAMES * barWidth;
+    float height = area.height / 4;
+    float x = area.x + area.width - width - fontSize;
+    float bottom = area.y + area.height - fontSize;
+    DrawRectangle(x - fontSize / 2, bottom - height - 2 * fontSize, width + fontSize, height + 2.5f * fontSize, STATS_COLOR);
+
+    double scale = height / (2 * 1e9 / FRAMES);
+    int first = std::max(frames.getSize() - PROFILE_GRAPH_FRAMES, 0);
+    for (int i = first; i < frames.getSize(); i += 1)
+    {
+        FrameTimes& times = frames.get(i);
+        float y = bottom;
+        for (int zone = INPUT_ZONE; zone < PROFILE_ZONES; zone += 1)
+        {
+            float barHeight = std::min((double)times.zones[zone] * scale, (double)(y - (bottom - height)));
+            y -= barHeight;
+            DrawRectangle(x + (i - first) * barWidth, y, barWidth, barHeight, zoneColors[zone]);
+        }
+    }
+    DrawLine(x, bottom - height / 2, x + width, bottom - height / 2, LINE_COLOR);
+
+    // the names in the colors of their zones and the time of the last frame
+    float nameX = x;
+    for (int zone = INPUT_ZONE; zone < PROFILE_ZONES; zone += 1)
+    {
+        DrawText(ZONE_NAMES[zone], nameX, bottom - height - 1.5f * fontSize, fontSize, zoneColors[zone]);
+        nameX += MeasureText(ZONE_NAMES[zone], fontSize) + fontSize / 2;
+    }
+    if (frames.isEmpty()) return;
+    double last = frames.get(frames.getSize() - 1).zones[FRAME_ZONE] / 1e6;
+    DrawText(TextFormat("%.2f ms", last), nameX, bottom - height - 1.5f * fontSize, fontSize, BLACK);
+}
+
+// writes the zones the profiler kept to PROFILE_CSV_FILE and PROFILE_TRACE_FILE
+void dumpProfile()
+{
+    std::ofstream csv(PROFILE_CSV_FILE);
+    std::ofstream trace(PROFILE_TRACE_FILE);
+    if (!csv || !trace)
+    {
+        TraceLog(LOG_WARNING, "can not write the frame profile");
+        return;
+    }
+    profiler.writeCsv(csv);
+    profiler.writeTrace(trace);
+}
+
 // main loop variables
 static Vector2 mouse;
 static bool isLeftClicked;
 static bool isLeftPressed;
 static Vector2 diff;
-static Rectangle rect;
 static Vector2 sPoint;
 static Vector2 ePoint;
 
-void mainLoop(void)
+void handleInput()
 {
-    BeginDrawing();
-    ClearBackground(WHITE);
-
-    DrawRectangle(0, screenHeight / SCREEN_PARTS, screenWidth, (SCREEN_PARTS - 1) * screenHeight / (SCREEN_PARTS), LIGHTGRAY);
-
+    ScopedZone zone(profiler, INPUT_ZONE);
 
     // managing buttons
     mouse = GetMousePosition();
@@ -211,19 +411,33 @@ void mainLoop(void)
     }
     searcher->zoom(mouse, (int)GetMouseWheelMove());
 
-    // update the searcher and start the iterator
-    searcher->update(iter);
+    if (IsKeyPressed(STATS_KEY)) showStats = !showStats;
+    if (IsKeyPressed(STATS_DUMP_KEY)) dumpStats();
+    if (IsKeyPressed(PROFILE_KEY)) showProfile = !showProfile;
+    if (IsKeyPressed(PROFILE_DUMP_KEY)) dumpProfile();
+}
 
+// the settled cells come from the canvas texture, only the changed ones are written
+// the canvas left undrawn misses the changes, so it's written again when it's back
+void drawCells()
+{
+    ScopedZone zone(profiler, CELLS_ZONE);
 
-    while (iter.hasNext())
+    if (searcher->isZoomedOut())
     {
-        iter.next();
-        if (searcher->isValidRect(iter.getKey()))
-        {
-            searcher->generateRect(iter.getKey(), &rect, &iter.getValue());
-            DrawRectangle(rect.x, rect.y, rect.width, rect.height, COLORS[iter.getValue().ct]);
-        }
+        canvas.outdate();
+        blockCanvas.draw(*searcher);
     }
+    else
+    {
+        blockCanvas.outdate();
+        canvas.draw(*searcher);
+    }
+}
+
+void drawGridLines()
+{
+    ScopedZone zone(profiler, LINES_ZONE);
 
     for (int col = 1; searcher->isColumn(col); col += 1)
     {
@@ -236,11 +450,44 @@ void mainLoop(void)
         searcher->getRow(row, &sPoint, &ePoint);
         DrawLineV(sPoint, ePoint, LINE_COLOR);
     }
+}
+
+void mainLoop(void)
+{
+    profiler.beginFrame();
+
+    BeginDrawing();
+    ClearBackground(WHITE);
+
+    DrawRectangle(0, screenHeight / SCREEN_PARTS, screenWidth, (SCREEN_PARTS - 1) * screenHeight / (SCREEN_PARTS), LIGHTGRAY);
+
+    handleInput();
+
+    profiler.begin(UPDATE_ZONE);
+    searcher->update();
+    profiler.end(UPDATE_ZONE);
 
+    drawCells();
+    // the cells are too small for lines between them when zoomed out
+    if (!searcher->isZoomedOut()) drawGridLines();
+
+    profiler.begin(OVERLAY_ZONE);
+    if (showStats) drawStats();
+    if (showProfile) drawProfile();
+    profiler.end(OVERLAY_ZONE);
+
+    // the frame waits here for its time to come
+    profiler.begin(PRESENT_ZONE);
     EndDrawing();
+    profiler.end(PRESENT_ZONE);
+
+    profiler.endFrame();
 }
 
-int main()
+// usage: visualizer [map file] [saved map]
+// the map is a MovingAI map or one saved before, the walls are saved
+// to the second file when the window is closed
+int main(int argc, char** argv)
 {
     InitWindow(screenWidth, screenHeight, "Visualizer");
     
@@ -252,6 +499,12 @@ int main()
 
     searcher = new Dijkstra(Vector2{.x = 0, .y = screenHeight / (SCREEN_PARTS)},
          Vector2{.x = screenWidth, .y = (SCREEN_PARTS - 1) * screenHeight / (SCREEN_PARTS)});
+    searcher->setCache(&pathCache);
+
+    if (argc > 1 && !searcher->openMap(argv[1]))
+    {
+        TraceLog(LOG_WARNING, "can not read the map %s", argv[1]);
+    }
 
     initButtons();
 
@@ -266,6 +519,13 @@ int main()
         }
     #endif
 
+    if (argc > 2 && !searcher->saveMap(argv[2]))
+    {
+        TraceLog(LOG_WARNING, "can not write the map %s", argv[2]);
+    }
+
+    canvas.unload();
+    blockCanvas.unload();
     delete searcher;
     CloseWindow();
 
@@ -0,0 +1,104 @@
+#ifndef MAPS_H
+#define MAPS_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string.h>
+
+#include "../data_structures/arraylist.hpp"
+
+#include "./engine.hpp"
+
+// tiles of the MovingAI maps that can be walked on
+inline bool isPassableTile(char tile)
+{
+    return tile == '.' || tile == 'G' || tile == 'S';
+}
+
+// reads a MovingAI grid map (the .map format) into the engine,
+// every tile that can't be walked on becomes a wall
+// a map saved by SearchEngine::saveWalls is mapped instead of read
+// returns false if the file can't be read
+inline bool loadMap(SearchEngine& engine, const char* path)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+
+    char tag[4] = {};
+    file.read(tag, 4);
+    if (file && memcmp(tag, BIT_PLANE_TAG, 4) == 0)
+    {
+        engine.removeEndpoints();
+        return engine.mapWalls(path);
+    }
+    file.clear();
+    file.seekg(0);
+
+    int width = -1;
+    int height = -1;
+    std::string word;
+
+    // the header ends with the line "map"
+    while (file >> word && word != "map")
+    {
+        if (word == "width") file >> width;
+        else if (word == "height") file >> height;
+    }
+    if (word != "map" || width <= 0 || height <= 0) return false;
+
+    engine.removeEndpoints();
+    engine.clear();
+    engine.setSize(width, height);
+
+    std::string row;
+    for (int y = 0; y < height && file >> row; y += 1)
+    {
+        for (int x = 0; x < width && x < (int)row.size(); x += 1)
+        {
+            if (!isPassableTile(row[x])) engine.putToGrid(Vector2I{.x = x, .y = y}, WALL, 0);
+        }
+    }
+    return true;
+}
+
+// one query of a MovingAI scenario file
+struct Scenario
+{
+    int bucket;
+    Vector2I source;
+    Vector2I target;
+    // the length given by the file, measured with diagonals costing sqrt(2)
+    double optimalLength;
+};
+
+// reads a MovingAI scenario file (the .scen format)
+// returns false if the file can't be read
+inline bool loadScenarios(const char* path, ArrayList<Scenario>& scenarios)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // the first line holds the version
+        if (line.compare(0, 7, "version") == 0) continue;
+
+        std::istringstream fields(line);
+        Scenario scenario;
+        std::string mapName;
+        int width;
+        int height;
+
+        if (fields >> scenario.bucket >> mapName >> width >> height
+            >> scenario.source.x >> scenario.source.y
+            >> scenario.target.x >> scenario.target.y >> scenario.optimalLength)
+        {
+            scenarios.push(scenario);
+        }
+    }
+    return true;
+}
+
+#endif
\ No newline at end of file
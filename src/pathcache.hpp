@@ -0,0 +1,120 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../data_structures/arraylist.hpp"
+#include "../data_structures/lrucache.hpp"
+
+#include "./engine.hpp"
+
+// keeps the last finished searches, a search asked again for the same
+// endpoints, engine and walls is put back without searching
+
+#define PATH_CACHE_SIZE 1024
+
+struct PathKey
+{
+    Vector2I source;
+    Vector2I target;
+    const char* algorithm;
+    uint64_t version;
+
+    bool operator==(const PathKey& other) const
+    {
+        return source.x == other.source.x && source.y == other.source.y &&
+                target.x == other.target.x && target.y == other.target.y &&
+                version == other.version && strcmp(algorithm, other.algorithm) == 0;
+    }
+};
+
+template<>
+struct std::hash<PathKey>
+{
+    size_t operator()(const PathKey &k) const
+    {
+        return hashCell(k.source.x, k.source.y) ^ (hashCell(k.target.x, k.target.y) * 31) ^ k.version;
+    }
+};
+
+struct CachedPath
+{
+    bool found;
+    // from the target back to the source, see SearchEngine::getPath
+    ArrayList<Vector2I> cells;
+};
+
+class PathCache
+{
+private:
+    LRUCache<PathKey, CachedPath> paths;
+
+    long hits;
+    long misses;
+
+    PathKey keyOf(SearchEngine& engine)
+    {
+        return PathKey{engine.getSourcePos(), engine.getTargetPos(), engine.getName(), engine.getGridVersion()};
+    }
+
+    // an engine that repairs its search on wall edits needs its own tables
+    bool caches(SearchEngine& engine)
+    {
+        return !engine.editsWhileRunning();
+    }
+
+public:
+    PathCache(int capacity = PATH_CACHE_SIZE) : paths(capacity)
+    {
+        hits = 0;
+        misses = 0;
+    }
+
+    // puts back the cached search of the engine's endpoints if there is one,
+    // otherwise returns false and the engine has to run
+    bool lookup(SearchEngine& engine)
+    {
+        if (!caches(engine)) return false;
+
+        CachedPath* cached = paths.find(keyOf(engine));
+        if (cached == nullptr)
+        {
+            misses += 1;
+            return false;
+        }
+        hits += 1;
+        engine.replayPath(cached->found, cached->cells);
+        return true;
+    }
+
+    // keeps the result of a finished search
+    void store(SearchEngine& engine)
+    {
+        if (!caches(engine)) return;
+
+        CachedPath& cached = paths.put(keyOf(engine));
+        cached.found = engine.isPathFound();
+        engine.getPath(cached.cells);
+    }
+
+    void clear()
+    {
+        paths.clear();
+        hits = 0;
+        misses = 0;
+    }
+
+    long getHits() {return hits;}
+    long getMisses() {return misses;}
+
+    float getHitRate()
+    {
+        return hits + misses > 0 ? (float)hits / (hits + misses) : 0;
+    }
+
+    int getSize() {return paths.getSize();}
+    int getCapacity() {return paths.getCapacity();}
+};
+
+#endif
@@ -1,81 +1,36 @@
 #ifndef SEARCHER_H
 #define SEARCHER_H
 
-#include <ctime>
 #include <math.h>
-#include <time.h>
 
 #include "../include/raylib/src/raylib.h"
-#include "../data_structures/hashtable.hpp"
-#include "../data_structures/heap.hpp"
+#include "./engine.hpp"
+#include "./landmarks.hpp"
+#include "./maps.hpp"
+#include "./pathcache.hpp"
+#include "./searchstats.hpp"
+#include "./searchworker.hpp"
+#include "./stepscheduler.hpp"
 
 #define MIN_CELL_DIMENSION 10.0f
-#define ITERATIONS_PER_UPDATE 100
+// below MIN_CELL_DIMENSION every zoom step scales the cells by ZOOM_FACTOR,
+// down to SMALLEST_CELL_DIMENSION, and below LOD_CELL_DIMENSION the cells
+// are drawn by blocks
+#define SMALLEST_CELL_DIMENSION 0.25f
+#define LOD_CELL_DIMENSION 4.0f
+#define ZOOM_FACTOR 1.25f
+// the most cells a frame shows, 0 shows as many as fit the frame budget
+#define DEFAULT_PLAYBACK_RATE 1000
 #define SIZE_ANIMATION_TIME 0.2f
 #define LINEAR_ANIMATION_TIME 0.5f
-#define CELLS_NUMBERS 800.0f
 
 
 #define SOURCE_COLOR GetColor((int)0xFF6F00FF)
 #define TARGET_COLOR DARKBLUE
 #define WALL_COLOR BROWN
 
-enum CellType
-{
-    CHECKED = 0, WALL = 1, PATH = 2, SOURCE = 3, TARGET = 4, REMOVE, 
-};
-
 const Color COLORS[] = {SKYBLUE, WALL_COLOR, YELLOW, SOURCE_COLOR, TARGET_COLOR,};
 
-struct Cell
-{
-    CellType ct;
-    double st;
-};
-
-struct Vector2I
-{
-    int x;
-    int y;
-    Vector2I& operator=(const Vector2I& v1)
-    {
-        this->x = v1.x;
-        this->y = v1.y;
-        return *this;
-    }
-
-    Vector2I& operator=(const Vector2& v1)
-    {
-        this->x = (int)v1.x;
-        this->y = (int)v1.y;
-        return *this;
-    }
-
-    inline bool operator==(const Vector2I& rhs)
-    {
-        return this->x == rhs.x && this->y == rhs.y;
-    }
-
-    inline bool operator!=(const Vector2I& rhs)
-    {
-        return this->x != rhs.x || this->y != rhs.y;
-    }
-    size_t operator()(const Vector2I &p) const
-    {
-        return std::hash<int>()(this->x + this->y);
-    }
-
-};
-
-template<>
-struct std::hash<Vector2I>
-{
-    size_t operator()(const Vector2I &p) const
-    {
-        return std::hash<int>()(p.x + p.y);
-    }
-};
-
 class Searcher
 {
 private:
@@ -91,14 +46,12 @@ private:
 
     struct Grid
     {
-        int cellDimension;
+        float cellDimension;
         Vector2 startingPoint;
         Vector2 cellsNumber;
         Vector2 dimensions;
-        Hashtable<Vector2I, Cell> table;
     };
 
-    bool running;
     CellType selectedType;
     Grid grid;
     Vector2I lastInsertedCell;
@@ -106,28 +59,107 @@ private:
     LinearAnimation targetAnimation;
 
 protected:
-    Vector2I sourcePos;
-    Vector2I targetPos;
-    // searching 
-    Heap<Vector2I> heap;
+    // does the searching, the searcher only draws it and handles the input
+    SearchEngine* engine;
+
+    // shared by the searchers, the search being shown came from it or was
+    // put in it already
+    PathCache* cache;
+    bool cached;
+
+    // searches on its own thread when the engine can, the frames only
+    // play its cells back, nullptr when the engine steps with the frames
+    SearchWorker* worker;
+    int playbackRate;
+
+    // how many steps or cells fit in a frame
+    StepScheduler scheduler;
+    // the search is over once run() returns, the frames only show it
+    bool instant;
+
+    // times the searches done on this thread, the worker times its own
+    PhaseTimer timer;
+    // the search shown was done by the worker, its stats are there
+    bool workerSearch;
+
+    // doubles, so the view stays exact far out in a large world
+    double xDiff;
+    double yDiff;
     
-    // contains the cell's key as a key, 
-    // and the distance to the source as the value
-    Hashtable<Vector2I, float> distTo;
+    // helper methods
+    // ---------------------------------------------------------------------------------------------------------
 
-    // contains the cell's key as a key,
-    // and the key of the cell before it
-    Hashtable<Vector2I, Vector2I> from;
+    static SearchWorker* newWorker(SearchEngine* workerEngine)
+    {
+    #if defined(PLATFORM_WEB)
+        // no threads here, every search steps with the frames
+        delete workerEngine;
+        return nullptr;
+    #else
+        return workerEngine != nullptr ? new SearchWorker(workerEngine) : nullptr;
+    #endif
+    }
 
-    bool pathFound;
+    // the shown search goes away with the worker's, before the engine is changed
+    void stopWorker()
+    {
+        if (worker != nullptr) worker->stop();
+        workerSearch = false;
+    }
 
-    Vector2I currentPos;
+    // the steps or cells this frame may do
+    int frameUnits()
+    {
+        int units = scheduler.getUnits();
+        return playbackRate > 0 ? std::min(units, playbackRate) : units;
+    }
 
-    float xDiff;
-    float yDiff;
-    
-    // helper methods
-    // ---------------------------------------------------------------------------------------------------------
+    // does up to units steps, a search that finds its path stops there
+    // so the time of the steps goes to one phase, returns the steps done
+    int stepEngine(int units, bool* finished)
+    {
+        bool found = engine->isPathFound();
+        int steps = 0;
+        timer.begin();
+        for (; steps < units && !*finished && engine->isPathFound() == found; steps += 1)
+        {
+            *finished = !engine->step();
+        }
+        timer.end(found ? PATH_PHASE : SEARCH_PHASE);
+        return steps;
+    }
+
+    // shows the cells the worker sent, as many as the frame takes
+    void playBack()
+    {
+        double time = GetTime();
+        CellEvent event;
+        int units = frameUnits();
+        int shown = 0;
+        scheduler.begin();
+        for (; shown < units && worker->poll(&event); shown += 1)
+        {
+            if (event.type == SEARCH_OVER)
+            {
+                worker->finish(*engine);
+                // a refused search stays stopped and isn't cached
+                if (worker->hasFailed())
+                {
+                    TraceLog(LOG_WARNING, "%s", worker->getError());
+                    engine->resetSearch();
+                    break;
+                }
+                if (cache != nullptr && !cached)
+                {
+                    cache->store(*engine);
+                    cached = true;
+                }
+                break;
+            }
+            engine->putToGrid(event.pos, (CellType)event.type, time);
+        }
+        scheduler.end(shown);
+    }
 
     // used for converting screen position to grid position
     virtual Vector2I getGridCoordinates(Vector2 mouse)
@@ -145,28 +177,18 @@ protected:
             && newMouse.y < grid.startingPoint.y + grid.dimensions.y;
     }
 
-    virtual void addEdgeFrom(Vector2I vertex, Vector2I fromVertex)
-    {
-        float dx = vertex.x - fromVertex.x;
-        float dy = vertex.y - fromVertex.y;
-        float distance = abs(dx) + abs(dy);
-
-        distTo.insert(vertex, distTo.get(fromVertex) + distance);
-        from.insert(vertex, fromVertex);
-        heap.add(vertex, distTo.get(vertex));
-    }
-
     virtual void applyDiffConstraints()
     {
-        const float maxX = CELLS_NUMBERS * MIN_CELL_DIMENSION;
-        const float maxY = CELLS_NUMBERS * MIN_CELL_DIMENSION;
+        const double maxX = (double)engine->getWidth() * MIN_CELL_DIMENSION;
+        const double maxY = (double)engine->getHeight() * MIN_CELL_DIMENSION;
 
-        if (xDiff > 0) xDiff = 0;
+        // a map smaller than the view stays at its corner
+        if (xDiff > 0 || grid.cellsNumber.x >= engine->getWidth()) xDiff = 0;
         else if (-xDiff * MIN_CELL_DIMENSION / grid.cellDimension + grid.cellsNumber.x * MIN_CELL_DIMENSION > maxX)
         {
             xDiff = -(maxX - grid.cellsNumber.x * MIN_CELL_DIMENSION) * grid.cellDimension / MIN_CELL_DIMENSION;
         }
-        if (yDiff > 0) yDiff = 0;
+        if (yDiff > 0 || grid.cellsNumber.y >= engine->getHeight()) yDiff = 0;
         else if (-yDiff * MIN_CELL_DIMENSION / grid.cellDimension + grid.cellsNumber.y * MIN_CELL_DIMENSION > maxY)
         {
             yDiff = -(maxY - grid.cellsNumber.y * MIN_CELL_DIMENSION) * grid.cellDimension / MIN_CELL_DIMENSION;
@@ -196,26 +218,6 @@ protected:
         }
     }
 
-    virtual bool isValidCell(Vector2I cell)
-    {
-        return cell.x >= 0 && cell.y >= 0 &&
-                cell.x < CELLS_NUMBERS && cell.y < CELLS_NUMBERS;
-    }
-
-    virtual void resetSearch()
-    {
-        ArrayList<Vector2I> walls;
-        Hashtable<Vector2I, Cell>::HashIterator iter;
-        iter.begin(grid.table);
-        while (iter.hasNext())
-        {
-            iter.next();
-            if (iter.getValue().ct == WALL) walls.push(iter.getKey());
-        }
-        clear();
-        for (int i = 0; i < walls.getSize(); i += 1) putToGrid(walls.get(i), WALL, 0);
-    }
-
     virtual Vector2 getAnimationPos(CellType ct, double now, double st)
     {
         Vector2 pos;
@@ -224,6 +226,7 @@ protected:
         {
             if (timeDiff > LINEAR_ANIMATION_TIME)
             {
+                Vector2I sourcePos = engine->getSourcePos();
                 pos = Vector2{.x = (float)sourcePos.x, .y = (float)sourcePos.y};
             }
             else
@@ -237,6 +240,7 @@ protected:
         {
             if (timeDiff > LINEAR_ANIMATION_TIME)
             {
+                Vector2I targetPos = engine->getTargetPos();
                 pos = Vector2{.x = (float)targetPos.x, .y = (float)targetPos.y};
             }
             else
@@ -249,16 +253,6 @@ protected:
         return pos;
     }
 
-    bool isGoodCorner(Vector2I pos, int x, int y)
-    {
-        Vector2I firstWall = Vector2I{.x = x + pos.x, .y = pos.y};
-        Vector2I secondWall = Vector2I{.x = pos.x, .y = y + pos.y};
-
-        if (!grid.table.containsKey(firstWall) || !grid.table.containsKey(secondWall)) return true;
-
-        return grid.table.get(firstWall).ct != WALL || grid.table.get(secondWall).ct != WALL;
-    }
-
     virtual void handleAnimation(Vector2I pos, Rectangle* rect, Cell* cell)
     {
         double now = GetTime();
@@ -281,83 +275,96 @@ protected:
 
         float center = (grid.cellDimension - rect->width) / 2.0f;
         
-        rect->x = cellPos.x * grid.cellDimension + grid.startingPoint.x + xDiff + center;
-        rect->y = cellPos.y * grid.cellDimension + grid.startingPoint.y + yDiff + center;
+        rect->x = (double)cellPos.x * grid.cellDimension + grid.startingPoint.x + xDiff + center;
+        rect->y = (double)cellPos.y * grid.cellDimension + grid.startingPoint.y + yDiff + center;
+    }
+
+    // starts moving the drawn source or target from where it is now to key
+    void startAnimation(LinearAnimation* animation, CellType ct, Vector2I key, double st)
+    {
+        animation->lastPos = getAnimationPos(ct, GetTime(), st);
+
+        int yCellDiff = key.y - animation->lastPos.y;
+        int xCellDiff = key.x - animation->lastPos.x;
+
+        animation->distance = sqrt(pow(yCellDiff, 2) + pow(xCellDiff, 2));
+        animation->slope = atan2(yCellDiff, xCellDiff);
     }
 
     virtual bool putToGrid(Vector2I key, CellType ct, double time)
     {
-        if (!isValidCell(key)) return false;
+        GridTable& table = engine->getGrid();
 
-        if (running)
+        // the engine only moves the source and the target to empty cells
+        bool moves = !engine->isRunning() && engine->isValidCell(key) && engine->getCellType(key) == -1;
+
+        if (moves && ct == SOURCE && table.containsKey(engine->getSourcePos()))
         {
-            // cell is not inserted if it's place is occupied by
-            // a wall or something of the same type
-            if (grid.table.containsKey(key))
-            {
-                if (grid.table.get(key).ct >= ct) return false;
-            }
+            startAnimation(&sourceAnimation, SOURCE, key, table.get(engine->getSourcePos()).st);
         }
-        else if (ct == REMOVE)
+        else if (moves && ct == TARGET && table.containsKey(engine->getTargetPos()))
         {
-            // user can only remove the walls
-            if (grid.table.containsKey(key) && (grid.table.get(key).ct == WALL))
-            {
-                grid.table.remove(key);
-            }
-            return false;
+            startAnimation(&targetAnimation, TARGET, key, table.get(engine->getTargetPos()).st);
         }
 
-        else if (grid.table.containsKey(key)) return false;
+        return engine->putToGrid(key, ct, time);
+    }
 
-        else if (ct == SOURCE)
+    // the first empty cell from pos on, row by row, or pos if there is none
+    Vector2I findEmptyCell(Vector2I pos)
+    {
+        long cellsNumber = (long)engine->getWidth() * engine->getHeight();
+        long start = (long)pos.y * engine->getWidth() + pos.x;
+        for (long i = 0; i < cellsNumber; i += 1)
         {
-            if (grid.table.containsKey(sourcePos))
-            {
-                sourceAnimation.lastPos = getAnimationPos(SOURCE, GetTime(), grid.table.get(sourcePos).st);
-
-                int sourceYDiff = key.y - sourceAnimation.lastPos.y;
-                int sourceXDiff = key.x - sourceAnimation.lastPos.x;
+            long index = (start + i) % cellsNumber;
+            Vector2I cell = Vector2I{.x = (int)(index % engine->getWidth()), .y = (int)(index / engine->getWidth())};
+            if (engine->getCellType(cell) == -1) return cell;
+        }
+        return pos;
+    }
 
-                sourceAnimation.distance = sqrt(pow(sourceYDiff, 2) + pow(sourceXDiff, 2));
-                sourceAnimation.slope = atan2(sourceYDiff, sourceXDiff);      
-                grid.table.remove(sourcePos);
-            }
+    // puts the source and the target on the empty cells nearest to where
+    // the view would have them
+    void placeEndpoints(int diffCellsX, int diffCellsY)
+    {
+        Vector2I targetPos = Vector2I{
+            .x = std::min(diffCellsX + (int)grid.cellsNumber.x / 5, engine->getWidth() - 1),
+            .y = std::min(diffCellsY + (int)grid.cellsNumber.y / 2, engine->getHeight() - 1)
+        };
+        Vector2I sourcePos = Vector2I{
+            .x = std::min(diffCellsX + 4 * (int)grid.cellsNumber.x / 5, engine->getWidth() - 1),
+            .y = targetPos.y
+        };
 
-            grid.table.insert(key, {ct, time});
-            sourcePos = key;
-            return false;
-        }
-        else if (ct == TARGET)
-        {
-            if (grid.table.containsKey(targetPos))
-            {
-                targetAnimation.lastPos = getAnimationPos(TARGET, GetTime(), grid.table.get(targetPos).st);
-
-                int targetYDiff = key.y - targetAnimation.lastPos.y;
-                int targetXDiff = key.x - targetAnimation.lastPos.x;
-                
-                targetAnimation.distance = sqrt(pow(targetYDiff, 2) + pow(targetXDiff, 2));
-                targetAnimation.slope = atan2(targetYDiff, targetXDiff);
-                grid.table.remove(targetPos);
-            }
-            grid.table.insert(key, {ct, time});
-            
+        targetPos = findEmptyCell(targetPos);
+        putToGrid(targetPos, TARGET, 0);
+        sourcePos = findEmptyCell(sourcePos);
 
-            targetPos = key;
-            return false;
-        }
+        targetAnimation.lastPos = (Vector2){.x = (float)targetPos.x, .y = (float)targetPos.y};
+        sourceAnimation.lastPos = (Vector2){.x = (float)sourcePos.x, .y = (float)sourcePos.y};
 
-        grid.table.insert(key, {ct, time});
-        return true;
+        putToGrid(sourcePos, SOURCE, 0);
     }
 
     // ---------------------------------------------------------------------------------------------------------
     
 
 public:
-    explicit Searcher(Vector2 startingPos, Vector2 dimensions)
+    // workerEngine is a second engine of the same kind for the worker thread,
+    // nullptr keeps the search on the drawing thread
+    explicit Searcher(Vector2 startingPos, Vector2 dimensions, SearchEngine* searchEngine, SearchEngine* workerEngine = nullptr)
     {
+        engine = searchEngine;
+        engine->recordChanges(true);
+        cache = nullptr;
+        cached = false;
+        worker = newWorker(workerEngine);
+        playbackRate = DEFAULT_PLAYBACK_RATE;
+        instant = false;
+        workerSearch = false;
+
+
         grid.startingPoint.x = startingPos.x;
         grid.startingPoint.y = startingPos.y;
 
@@ -370,32 +377,31 @@ public:
         grid.cellsNumber.y = dimensions.y / grid.cellDimension;
         
 
-        running = false;
-
         selectedType = WALL;
 
-        pathFound = false;
-
-        const int diffCellsX = (CELLS_NUMBERS - grid.cellsNumber.x) / 2;
-        const int diffCellsY = (CELLS_NUMBERS - grid.cellsNumber.y) / 2;
-
-        targetPos = Vector2I{.x = diffCellsX + (int)grid.cellsNumber.x / 5, .y = diffCellsY + (int)grid.cellsNumber.y / 2};
-        sourcePos = Vector2I{.x = diffCellsX + 4 * (int)grid.cellsNumber.x / 5, .y = diffCellsY + (int)grid.cellsNumber.y / 2};
+        const int diffCellsX = (engine->getWidth() - grid.cellsNumber.x) / 2;
+        const int diffCellsY = (engine->getHeight() - grid.cellsNumber.y) / 2;
 
-        targetAnimation.lastPos = (Vector2){.x = (float)targetPos.x, .y = (float)targetPos.y};
-        sourceAnimation.lastPos = (Vector2){.x = (float)sourcePos.x, .y = (float)sourcePos.y};
-
-        putToGrid(sourcePos, SOURCE, 0);
-        putToGrid(targetPos, TARGET, 0);
+        placeEndpoints(diffCellsX, diffCellsY);
 
         // move everything left and up
-        xDiff = -MIN_CELL_DIMENSION * diffCellsX * factor;
-        yDiff = -MIN_CELL_DIMENSION * diffCellsY * factor;
+        xDiff = -MIN_CELL_DIMENSION * (double)diffCellsX * factor;
+        yDiff = -MIN_CELL_DIMENSION * (double)diffCellsY * factor;
 
     }
 
-    explicit Searcher(Searcher* otherSearcher)
+    explicit Searcher(Searcher* otherSearcher, SearchEngine* searchEngine, SearchEngine* workerEngine = nullptr)
     {
+        engine = searchEngine;
+        engine->recordChanges(true);
+        cache = otherSearcher->cache;
+        cached = false;
+        worker = newWorker(workerEngine);
+        playbackRate = otherSearcher->playbackRate;
+        instant = otherSearcher->instant;
+        workerSearch = false;
+
+
         this->grid.startingPoint.x = otherSearcher->grid.startingPoint.x;
         this->grid.startingPoint.y = otherSearcher->grid.startingPoint.y;
 
@@ -408,74 +414,129 @@ public:
         
 
         
-        running = false;
         this->selectedType = otherSearcher->selectedType;
-        this->pathFound = otherSearcher->pathFound;
 
-        this->sourcePos = otherSearcher->sourcePos;
-        this->targetPos = otherSearcher->targetPos;
+        // the mapped walls move over, the other searcher goes away after this
+        engine->takeWalls(*otherSearcher->engine);
 
-        this->putToGrid(sourcePos, SOURCE, otherSearcher->grid.table.get(sourcePos).st);
-        this->putToGrid(targetPos, TARGET, otherSearcher->grid.table.get(targetPos).st);
+        GridTable& otherTable = otherSearcher->engine->getGrid();
+        Vector2I sourcePos = otherSearcher->engine->getSourcePos();
+        Vector2I targetPos = otherSearcher->engine->getTargetPos();
+
+        if (otherTable.containsKey(sourcePos)) engine->putToGrid(sourcePos, SOURCE, otherTable.get(sourcePos).st);
+        if (otherTable.containsKey(targetPos)) engine->putToGrid(targetPos, TARGET, otherTable.get(targetPos).st);
 
         this->xDiff = otherSearcher->xDiff;
         this->yDiff = otherSearcher->yDiff;
 
-        Hashtable<Vector2I, Cell>::HashIterator iter;
-        iter.begin(otherSearcher->grid.table);
+        GridTable::HashIterator iter;
+        iter.begin(otherTable);
 
         while (iter.hasNext())
         {
             iter.next();
             if (iter.getValue().ct == WALL)
             {
-                putToGrid(iter.getKey(), WALL, 0);
+                engine->putToGrid(iter.getKey(), WALL, 0);
             }
         }
 
-        pathFound = false;
         this->sourceAnimation = otherSearcher->sourceAnimation;
         this->targetAnimation = otherSearcher->targetAnimation;
     }
 
 
 
+    virtual ~Searcher()
+    {
+        delete worker;
+        delete engine;
+    }
+
     virtual void select(CellType ct)
     {
         selectedType = ct;
-        // reset the search if some cell type is selected
-        resetSearch();
+        stopWorker();
+        // reset the search if some cell type is selected,
+        // unless the engine takes wall edits while it runs
+        if (!engine->editsWhileRunning() || (ct != WALL && ct != REMOVE)) engine->resetSearch();
     }
+    void setCache(PathCache* pathCache) {cache = pathCache;}
+
     virtual void run()
     {
-        resetSearch();
-        running = true;
+        stopWorker();
+        timer.reset();
+        cached = cache != nullptr && cache->lookup(*engine);
+        if (cached) return;
 
-        from.insert(sourcePos, Vector2I{.x = -1000, .y = -1000});
-        distTo.insert(sourcePos, 0);
+        // engines that keep something for every cell can't run on a world
+        // this large, they stay stopped, the worker tells it once it's over
+        try
+        {
+            if (worker != nullptr)
+            {
+                worker->start(*engine);
+                workerSearch = true;
+            }
+            else
+            {
+                timer.begin();
+                engine->run();
+                timer.end(SETUP_PHASE);
+            }
 
-        heap.add(sourcePos, 0);
+            if (!instant) return;
+            if (worker != nullptr) worker->waitForSearch();
+            else
+            {
+                engine->setTime(GetTime());
+                bool finished = false;
+                while (!finished) stepEngine(MAX_FRAME_UNITS, &finished);
+            }
+        }
+        catch (std::runtime_error& e)
+        {
+            TraceLog(LOG_WARNING, "%s", e.what());
+        }
     }
     virtual void clear()
     {
-        heap.clear();
-        distTo.clear();
-        from.clear();
+        stopWorker();
+        engine->clear();
+    }
 
-        double sourceTime = grid.table.get(sourcePos).st;
-        double targetTime = grid.table.get(targetPos).st;
+    // opens a MovingAI map or a saved one, the view goes back to the first
+    // cell and the source and the target are put on empty cells
+    virtual bool openMap(const char* path)
+    {
+        stopWorker();
+        try
+        {
+            if (!loadMap(*engine, path)) return false;
+        }
+        catch (std::runtime_error& e)
+        {
+            TraceLog(LOG_WARNING, "%s", e.what());
+            return false;
+        }
 
-        grid.table.clear();
-        putToGrid(sourcePos, SOURCE, sourceTime);
-        putToGrid(targetPos, TARGET, targetTime);
+        xDiff = 0;
+        yDiff = 0;
+        placeEndpoints(0, 0);
+        return true;
+    }
 
-        running = false;
-        pathFound = false;
+    // saves the walls in the format openMap maps without reading
+    virtual bool saveMap(const char* path)
+    {
+        return engine->saveWalls(path);
     }
 
     virtual void press(Vector2 newMouse, bool isLeftPressed)
     {
-        if (!isLeftPressed || running || !isMouseInGrid(newMouse)) {
+        bool locked = engine->isRunning() && !engine->editsWhileRunning();
+        if (!isLeftPressed || locked || !isMouseInGrid(newMouse)) {
             this->lastInsertedCell = Vector2I{.x = -1, .y = -1};
             return;
         }
@@ -509,7 +570,15 @@ public:
         Vector2I mouseCell = getGridCoordinates(mouse);
         
         float oldCellDimension = grid.cellDimension;
-        grid.cellDimension = std::max(2 * n + grid.cellDimension, MIN_CELL_DIMENSION);
+        if (grid.cellDimension >= MIN_CELL_DIMENSION && 2 * n + grid.cellDimension >= MIN_CELL_DIMENSION)
+        {
+            grid.cellDimension += 2 * n;
+        }
+        else
+        {
+            grid.cellDimension = std::max(grid.cellDimension * powf(ZOOM_FACTOR, n), SMALLEST_CELL_DIMENSION);
+            grid.cellDimension = std::min(grid.cellDimension, MIN_CELL_DIMENSION);
+        }
 
         float sizeChange = grid.cellDimension - oldCellDimension;
 
@@ -526,24 +595,71 @@ public:
 
     virtual Vector2I getCurrentPos()
     {
-        return currentPos;
+        return engine->getCurrentPos();
     }
 
-    virtual bool isRunning() {return running;}
+    virtual bool isRunning() {return engine->isRunning();}
 
-    virtual bool isPathFound() {return pathFound;}
+    virtual bool isPathFound() {return engine->isPathFound();}
 
     // returns true if a position is to be drawn to the screen
     virtual bool isValidRect(Vector2I pos)
     {
 
-        float xCellDiff = (float)xDiff / (float)grid.cellDimension;
-        float yCellDiff = (float)yDiff / (float)grid.cellDimension;
+        double xCellDiff = xDiff / grid.cellDimension;
+        double yCellDiff = yDiff / grid.cellDimension;
 
         return xCellDiff + pos.x > -1 && yCellDiff + pos.y > -1 &&
                 xCellDiff + pos.x < grid.cellsNumber.x && yCellDiff + pos.y < grid.cellsNumber.y;
     }
 
+    // the first and the last cell the view may show
+    virtual void getVisibleCells(Vector2I* first, Vector2I* last)
+    {
+        first->x = std::max((int)floor(-xDiff / grid.cellDimension), 0);
+        first->y = std::max((int)floor(-yDiff / grid.cellDimension), 0);
+        last->x = first->x + (int)grid.cellsNumber.x + 1;
+        last->y = first->y + (int)grid.cellsNumber.y + 1;
+    }
+
+    // the cell at pos, returns false if it's empty, the mapped walls count too
+    bool findCell(Vector2I pos, Cell* cell)
+    {
+        if (engine->getCellType(pos) == -1) return false;
+
+        GridTable& table = engine->getGrid();
+        *cell = table.containsKey(pos) ? table.get(pos) : Cell{.ct = WALL, .st = 0};
+        return true;
+    }
+
+    // true while the cell grows or moves, it can't be drawn at its full size yet
+    bool isAnimating(Cell* cell)
+    {
+        return cell->ct == SOURCE || cell->ct == TARGET || GetTime() - cell->st < SIZE_ANIMATION_TIME;
+    }
+
+    // the screen rectangle of w * h cells from x, y at their full size
+    Rectangle getCellsRect(int x, int y, int w, int h)
+    {
+        return Rectangle{
+            .x = (float)((double)x * grid.cellDimension + grid.startingPoint.x + xDiff),
+            .y = (float)((double)y * grid.cellDimension + grid.startingPoint.y + yDiff),
+            .width = (float)w * grid.cellDimension,
+            .height = (float)h * grid.cellDimension
+        };
+    }
+
+    // the part of the screen the grid is drawn on
+    Rectangle getGridArea()
+    {
+        return Rectangle{.x = grid.startingPoint.x, .y = grid.startingPoint.y, .width = grid.dimensions.x, .height = grid.dimensions.y};
+    }
+
+    // the cells are too small to be drawn one by one
+    bool isZoomedOut() {return grid.cellDimension < LOD_CELL_DIMENSION;}
+
+    SearchEngine& getEngine() {return *engine;}
+
     // generates the rectangle to be drawn to the screen
     virtual void generateRect(Vector2I pos, Rectangle* rect, Cell* cell)
     {
@@ -556,9 +672,9 @@ public:
     virtual bool isColumn(int colNumber)
     {
 
-        int firstX = (int)xDiff % grid.cellDimension + grid.startingPoint.x;
+        float firstX = fmod(xDiff, grid.cellDimension) + grid.startingPoint.x;
 
-        int x = firstX + (colNumber - (firstX >= grid.startingPoint.x)) * grid.cellDimension;
+        float x = firstX + (colNumber - (firstX >= grid.startingPoint.x)) * grid.cellDimension;
 
         return x < grid.startingPoint.x + grid.dimensions.x;
     }
@@ -568,9 +684,9 @@ public:
         sp->y = grid.startingPoint.y;
         ep->y = grid.startingPoint.y + grid.dimensions.y;
 
-        int firstX = (int)xDiff % grid.cellDimension + grid.startingPoint.x;
+        float firstX = fmod(xDiff, grid.cellDimension) + grid.startingPoint.x;
 
-        int x = firstX + (colNumber - (firstX >= grid.startingPoint.x)) * grid.cellDimension;
+        float x = firstX + (colNumber - (firstX >= grid.startingPoint.x)) * grid.cellDimension;
 
         sp->x = x;
         ep->x = x;
@@ -578,9 +694,9 @@ public:
 
     virtual bool isRow(int rowNumber)
     {
-        int firstY = (int)yDiff % grid.cellDimension + grid.startingPoint.y;
+        float firstY = fmod(yDiff, grid.cellDimension) + grid.startingPoint.y;
         
-        int y = firstY + (rowNumber - (firstY >= grid.startingPoint.y)) * grid.cellDimension;
+        float y = firstY + (rowNumber - (firstY >= grid.startingPoint.y)) * grid.cellDimension;
 
         return y <= grid.startingPoint.y + grid.dimensions.y;
     }
@@ -591,66 +707,53 @@ public:
         sp->x = grid.startingPoint.x;
         ep->x = grid.startingPoint.x + grid.dimensions.x;
 
-        int firstY = (int)yDiff % grid.cellDimension + grid.startingPoint.y;
+        float firstY = fmod(yDiff, grid.cellDimension) + grid.startingPoint.y;
 
-        int y = firstY + (rowNumber - (firstY >= grid.startingPoint.y)) * grid.cellDimension;
+        float y = firstY + (rowNumber - (firstY >= grid.startingPoint.y)) * grid.cellDimension;
 
         sp->y = y;
         ep->y = y;
     }
 
-    virtual void update(Hashtable<Vector2I, Cell>::HashIterator& iter)
+    // the most cells shown every frame, 0 for as many as fit the frame budget
+    void setPlaybackRate(int rate) {playbackRate = rate;}
+    int getPlaybackRate() {return playbackRate;}
+
+    // an instant search is done by run(), the frames then show its cells
+    void setInstant(bool isInstant) {instant = isInstant;}
+    bool isInstant() {return instant;}
+
+    // the work of the search shown, as far as it got
+    void getStats(SearchStats& stats)
+    {
+        if (workerSearch) worker->getStats(stats);
+        else
+        {
+            engine->getStats(stats);
+            timer.fill(stats);
+        }
+    }
+
+    virtual void update()
     {
-        
-        if (running)
+        if (worker != nullptr && worker->isStarted()) playBack();
+        else if (engine->isRunning())
         {
-            for (int i = 0; i < ITERATIONS_PER_UPDATE; i += 1)
+            engine->setTime(GetTime());
+            bool finished = false;
+            int units = frameUnits();
+            int steps = 0;
+            scheduler.begin();
+            while (steps < units && !finished) steps += stepEngine(units - steps, &finished);
+            scheduler.end(steps);
+
+            // the search is over once the path is known or can't be found
+            if (cache != nullptr && !cached && (engine->isPathFound() || finished))
             {
-                if (!pathFound)
-                {
-                    
-                    if (!heap.isEmpty())
-                    {
-                        currentPos = heap.removeSmallest();
-                    }
-    
-                    for (int y = -1; y <= 1; y += 1)
-                    {
-                        for (int x = -1; x <= 1; x += 1)
-                        {
-                            if (abs(x) == abs(y))
-                            {
-                                if (!isGoodCorner(currentPos, x, y)) continue;
-                            }
-                            Vector2I newPos = (Vector2I){currentPos.x + x, currentPos.y + y};
-        
-                            if (newPos == targetPos)
-                            {
-                                pathFound = true;
-                                from.insert(targetPos, currentPos);
-                            }
-            
-                            // only add the new cell if it's added to the grid successfully
-                            if (putToGrid(newPos, CHECKED, GetTime()))
-                            {
-                                addEdgeFrom(newPos, currentPos);
-                            }
-    
-                        }
-                    }
-                }
-                else
-                {
-                    if (currentPos != sourcePos)
-                    {
-                        putToGrid(currentPos, PATH, GetTime());
-                        currentPos = from.get(currentPos);
-                    }
-                }
+                cache->store(*engine);
+                cached = true;
             }
         }
-
-        iter.begin(grid.table);
     }
 };
 
@@ -659,10 +762,10 @@ public:
 class Dijkstra : public Searcher
 {
 public:
-    Dijkstra(Vector2 startingPos, Vector2 dimensions):Searcher(startingPos, dimensions)
+    Dijkstra(Vector2 startingPos, Vector2 dimensions):Searcher(startingPos, dimensions, new DijkstraEngine(), new DijkstraEngine())
     {
     }
-    Dijkstra(Searcher* otherSearcher):Searcher(otherSearcher)
+    Dijkstra(Searcher* otherSearcher):Searcher(otherSearcher, new DijkstraEngine(), new DijkstraEngine())
     {
     }
 };
@@ -671,50 +774,93 @@ public:
 
 class AStar : public Searcher
 {
+public:
+    AStar(Vector2 startingPos, Vector2 dimensions):Searcher(startingPos, dimensions, new AStarEngine(), new AStarEngine())
+    {
+    }
+    AStar(Searcher* otherSearcher):Searcher(otherSearcher, new AStarEngine(), new AStarEngine())
+    {
+    }
+};
 
-protected:
-
-    float heuristic(Vector2I vertex)
+class BFS : public Searcher
+{
+public:
+    BFS(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new BFSEngine(), new BFSEngine())
+    {
+    }
+    BFS(Searcher* otherSearcher):Searcher(otherSearcher, new BFSEngine(), new BFSEngine())
     {
-        float dx = vertex.x - targetPos.x;
-        float dy = vertex.y - targetPos.y;
-        return sqrt(pow(dx, 2) + pow(dy, 2));
     }
 
-private:
-    void addEdgeFrom(Vector2I vertex, Vector2I fromVertex) override
+};
+
+
+
+class JPS : public Searcher
+{
+public:
+    JPS(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new JPSEngine(), new JPSEngine())
+    {
+    }
+    JPS(Searcher* otherSearcher):Searcher(otherSearcher, new JPSEngine(), new JPSEngine())
     {
-        float dx = vertex.x - fromVertex.x;
-        float dy = vertex.y - fromVertex.y;
-        float distance = abs(dx) + abs(dy);
-        
-        distTo.insert(vertex, distTo.get(fromVertex) + distance);
-        from.insert(vertex, fromVertex);
-        heap.add(vertex, distTo.get(vertex) + heuristic(vertex));
     }
+
+};
+
+
+
+class Bidirectional : public Searcher
+{
 public:
-    AStar(Vector2 startingPos, Vector2 dimensions):Searcher(startingPos, dimensions)
+    Bidirectional(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new BidirectionalEngine(), new BidirectionalEngine())
     {
     }
-    AStar(Searcher* otherSearcher):Searcher(otherSearcher)
+    Bidirectional(Searcher* otherSearcher):Searcher(otherSearcher, new BidirectionalEngine(), new BidirectionalEngine())
     {
     }
+
 };
 
-class BFS : public AStar
+
+
+// takes wall edits while it runs, so it searches on the drawing thread
+class LPAStar : public Searcher
 {
+public:
+    LPAStar(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new LPAStarEngine())
+    {
+    }
+    LPAStar(Searcher* otherSearcher):Searcher(otherSearcher, new LPAStarEngine())
+    {
+    }
 
-private:
-    void addEdgeFrom(Vector2I vertex, Vector2I fromVertex) override
+};
+
+
+
+class HPAStar : public Searcher
+{
+public:
+    HPAStar(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new HPAStarEngine(), new HPAStarEngine())
+    {
+    }
+    HPAStar(Searcher* otherSearcher):Searcher(otherSearcher, new HPAStarEngine(), new HPAStarEngine())
     {
-        from.insert(vertex, fromVertex);
-        heap.add(vertex, heuristic(vertex));
     }
+
+};
+
+
+
+class ALT : public Searcher
+{
 public:
-    BFS(Vector2 startingPoint, Vector2 dimension):AStar(startingPoint, dimension)
+    ALT(Vector2 startingPoint, Vector2 dimension):Searcher(startingPoint, dimension, new ALTEngine(), new ALTEngine())
     {
     }
-    BFS(Searcher* otherSearcher):AStar(otherSearcher)
+    ALT(Searcher* otherSearcher):Searcher(otherSearcher, new ALTEngine(), new ALTEngine())
     {
     }
 
@@ -0,0 +1,132 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../data_structures/arraylist.hpp"
+#include "../data_structures/flathashtable.hpp"
+#include "../data_structures/hashtable.hpp"
+
+// the work a search did, filled by the engine's getStats, the phase
+// times and the list resizes are measured by whoever steps the engine,
+// the engine itself knows nothing about timing
+
+enum SearchPhase
+{
+    SETUP_PHASE = 0, SEARCH_PHASE = 1, PATH_PHASE = 2,
+};
+#define SEARCH_PHASES 3
+
+const char* const PHASE_NAMES[] = {"setup", "search", "path",};
+
+struct SearchStats
+{
+    const char* algorithm;
+    bool pathFound;
+    int pathCost;
+
+    int expanded;
+    // the neighbors the expanded cells offered to the open list
+    int generated;
+    int pushes;
+    int pops;
+    int decreases;
+    int maxOpenSize;
+
+    // the hashed tables of the search, all 0 when the build keeps it in grids
+    long probes;
+    int rehashes;
+    int longestBucket;
+
+    long listResizes;
+    double phaseSeconds[SEARCH_PHASES];
+};
+
+// the tables that aren't hashed have nothing to add
+template <typename T>
+inline void addTableStats(SearchStats&, T&)
+{
+}
+
+template <typename K, typename V>
+inline void addTableStats(SearchStats& stats, FlatHashtable<K, V>& table)
+{
+    stats.probes += table.getProbes();
+    stats.rehashes += table.getRehashes();
+    stats.longestBucket = std::max(stats.longestBucket, table.getLongestBucket());
+}
+
+template <typename K, typename V>
+inline void addTableStats(SearchStats& stats, Hashtable<K, V>& table)
+{
+    stats.probes += table.getProbes();
+    stats.rehashes += table.getRehashes();
+    stats.longestBucket = std::max(stats.longestBucket, table.getLongestBucket());
+}
+
+// adds the time and the list resizes of every piece of work to its phase,
+// begin and end have to be called on the thread doing the work
+class PhaseTimer
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double seconds[SEARCH_PHASES];
+    long resizes;
+
+    Clock::time_point started;
+    long startResizes;
+
+public:
+    PhaseTimer()
+    {
+        reset();
+    }
+
+    // a new search starts
+    void reset()
+    {
+        for (int i = 0; i < SEARCH_PHASES; i += 1) seconds[i] = 0;
+        resizes = 0;
+    }
+
+    void begin()
+    {
+        started = Clock::now();
+        startResizes = arrayListResizes();
+    }
+
+    void end(SearchPhase phase)
+    {
+        seconds[phase] += std::chrono::duration<double>(Clock::now() - started).count();
+        resizes += arrayListResizes() - startResizes;
+    }
+
+    // puts the times and the resizes in stats
+    void fill(SearchStats& stats)
+    {
+        for (int i = 0; i < SEARCH_PHASES; i += 1) stats.phaseSeconds[i] = seconds[i];
+        stats.listResizes = resizes;
+    }
+};
+
+inline void writeStatsJson(std::ostream& out, SearchStats& stats)
+{
+    out << "{\"algorithm\": \"" << stats.algorithm << "\", \"found\": " << (stats.pathFound ? "true" : "false")
+        << ", \"cost\": " << stats.pathCost
+        << ", \"expanded\": " << stats.expanded << ", \"generated\": " << stats.generated
+        << ", \"pushes\": " << stats.pushes << ", \"pops\": " << stats.pops
+        << ", \"decreases\": " << stats.decreases << ", \"max_open_size\": " << stats.maxOpenSize
+        << ", \"probes\": " << stats.probes << ", \"rehashes\": " << stats.rehashes
+        << ", \"longest_bucket\": " << stats.longestBucket << ", \"list_resizes\": " << stats.listResizes
+        << ", \"microseconds\": {";
+    for (int i = 0; i < SEARCH_PHASES; i += 1)
+    {
+        out << "\"" << PHASE_NAMES[i] << "\": " << stats.phaseSeconds[i] * 1e6 << (i + 1 < SEARCH_PHASES ? ", " : "");
+    }
+    out << "}}" << std::endl;
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef SEARCH_WORKER_H
+#define SEARCH_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../data_structures/arraylist.hpp"
+#include "../data_structures/spscring.hpp"
+
+#include "./engine.hpp"
+#include "./searchstats.hpp"
+
+// runs a search on its own thread with its own engine, so the search goes
+// as fast as it can whatever the frame rate, the cells it puts are sent to
+// the drawing thread as events through a ring and played back from there
+// at any pace
+// the worker's engine is only touched by the main thread while the worker
+// isn't running, the ring is the only thing both threads share
+
+#define WORKER_EVENTS (1 << 16)
+// the steps done between two sends of the new events
+#define WORKER_STEPS 256
+// the type of the last event, the search is over and its result can be taken
+#define SEARCH_OVER -1
+
+struct CellEvent
+{
+    Vector2I pos;
+    int type;
+};
+
+class SearchWorker
+{
+private:
+    SearchEngine* engine;
+    std::thread thread;
+    bool started;
+    std::atomic<bool> stopping;
+    // the search is over, only its events may be left to send
+    std::atomic<bool> searched;
+
+    SPSCRing<CellEvent> events;
+
+    // the events that didn't fit in the ring yet, only the worker uses them
+    ArrayList<CellEvent> pending;
+    int sent;
+
+    // why the engine refused the search, empty if it didn't, only read
+    // once the worker is done
+    std::string error;
+
+    // the stats of the search as of the last batch, the worker writes
+    // them and the drawing thread reads them, both under statsLock
+    PhaseTimer timer;
+    SearchStats progress;
+    std::mutex statsLock;
+
+    void publish()
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        engine->getStats(progress);
+        timer.fill(progress);
+    }
+
+    // sends the pending events the ring has room for
+    void send()
+    {
+        while (sent < pending.getSize() && events.push(pending.get(sent))) sent += 1;
+        if (sent == pending.getSize() && sent > 0)
+        {
+            pending.clear();
+            sent = 0;
+        }
+    }
+
+    // the search doesn't wait for the ring, the events pile up meanwhile
+    // the setup of the search is done here too, so a long one like the
+    // landmarks or the clusters being built again doesn't hold the frames
+    void work()
+    {
+        timer.begin();
+        try
+        {
+            engine->run();
+        }
+        catch (std::runtime_error& e)
+        {
+            error = e.what();
+        }
+        timer.end(SETUP_PHASE);
+        publish();
+
+        ArrayList<Vector2I> changed;
+        engine->logChanges(&changed);
+
+        bool searching = error.empty();
+        while (searching && !stopping)
+        {
+            // a batch ends where the path is found, so its time goes to one phase
+            bool found = engine->isPathFound();
+            timer.begin();
+            for (int i = 0; i < WORKER_STEPS && searching && engine->isPathFound() == found; i += 1)
+            {
+                searching = engine->step();
+            }
+            timer.end(found ? PATH_PHASE : SEARCH_PHASE);
+            // the path walk only adds time, the stats wait for its end
+            if (!found) publish();
+
+            for (int i = 0; i < changed.getSize(); i += 1)
+            {
+                CellEvent event = CellEvent{.pos = changed.get(i), .type = engine->getCellType(changed.get(i))};
+                if (event.type == CHECKED || event.type == PATH) pending.push(event);
+            }
+            if (changed.getSize() > 0) changed.clear();
+            send();
+        }
+        engine->logChanges(nullptr);
+        publish();
+        searched = true;
+
+        CellEvent over = CellEvent{.pos = engine->getCurrentPos(), .type = SEARCH_OVER};
+        pending.push(over);
+        while (!stopping && sent < pending.getSize())
+        {
+            send();
+            if (sent < pending.getSize()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+public:
+    // the worker owns the engine, it has to be of the kind the events are shown with
+    SearchWorker(SearchEngine* searchEngine) : events(WORKER_EVENTS)
+    {
+        engine = searchEngine;
+        started = false;
+        stopping = false;
+        searched = false;
+        sent = 0;
+        engine->getStats(progress);
+        timer.fill(progress);
+    }
+    ~SearchWorker()
+    {
+        stop();
+        delete engine;
+    }
+
+    SearchWorker(const SearchWorker&) = delete;
+    SearchWorker& operator=(const SearchWorker&) = delete;
+
+    // runs the search of shown's walls and endpoints, shown follows it
+    // and gets its cells from poll, if the engine refuses the search the
+    // error is known once it's over
+    void start(SearchEngine& shown)
+    {
+        stop();
+        if (engine->getGridVersion() != shown.getGridVersion() ||
+            engine->getWidth() != shown.getWidth() || engine->getHeight() != shown.getHeight())
+        {
+            engine->copyWalls(shown);
+        }
+        engine->setEndpoints(shown.getSourcePos(), shown.getTargetPos());
+        timer.reset();
+        error.clear();
+        publish();
+
+        shown.follow();
+        stopping = false;
+        searched = false;
+        started = true;
+        thread = std::thread(&SearchWorker::work, this);
+    }
+
+    // takes the next event, returns false if there is none for now
+    bool poll(CellEvent* event)
+    {
+        return started && events.pop(event);
+    }
+
+    // waits until the search is over, its events are still to be polled
+    void waitForSearch()
+    {
+        while (started && !searched) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // waits for the worker once the SEARCH_OVER event was polled, shown
+    // takes the path and the counters of the search
+    void finish(SearchEngine& shown)
+    {
+        stop();
+        shown.takeSearch(*engine);
+    }
+
+    // drops the search and whatever it didn't send
+    void stop()
+    {
+        if (!started) return;
+        stopping = true;
+        thread.join();
+        started = false;
+        events.clear();
+        pending.clear();
+        sent = 0;
+    }
+
+    bool isStarted() {return started;}
+
+    // the search was refused, only known once it's over
+    bool hasFailed() {return !error.empty();}
+    const char* getError() {return error.c_str();}
+
+    // the stats of the last search started, as far as it got
+    void getStats(SearchStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        stats = progress;
+    }
+
+    SearchEngine& getEngine() {return *engine;}
+};
+
+#endif
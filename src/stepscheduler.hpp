@@ -0,0 +1,72 @@
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+
+// decides how much work a frame does, the time every unit of work took is
+// measured and smoothed, and the next frame does as many units as fit in
+// the budget, so a slow machine still keeps its frame rate and a fast one
+// isn't held back by a fixed count
+
+// the seconds of a frame the work may take, a frame at 60 fps has 0.0167
+#define FRAME_BUDGET 0.006
+// the share of the newest measure in the smoothed time of a unit
+#define BUDGET_SMOOTHING 0.25
+#define MIN_FRAME_UNITS 1
+#define MAX_FRAME_UNITS (1 << 20)
+// the units of the first frame, before anything was measured
+#define FIRST_FRAME_UNITS 100
+
+class StepScheduler
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double budget;
+    // the smoothed seconds of one unit, 0 until something was measured
+    double unitTime;
+    int units;
+
+    Clock::time_point started;
+
+public:
+    StepScheduler(double budget = FRAME_BUDGET)
+    {
+        this->budget = budget;
+        unitTime = 0;
+        units = FIRST_FRAME_UNITS;
+    }
+
+    // the units the next frame may do
+    int getUnits() {return units;}
+
+    // the work of a frame starts now
+    void begin()
+    {
+        started = Clock::now();
+    }
+
+    // the work started by begin() ended after done units
+    void end(int done)
+    {
+        double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        record(done, seconds);
+    }
+
+    void record(int done, double seconds)
+    {
+        if (done <= 0) return;
+
+        double time = seconds / done;
+        unitTime = unitTime > 0 ? unitTime + (time - unitTime) * BUDGET_SMOOTHING : time;
+
+        double fitting = unitTime > 0 ? budget / unitTime : MAX_FRAME_UNITS;
+        units = (int)std::min(std::max(fitting, (double)MIN_FRAME_UNITS), (double)MAX_FRAME_UNITS);
+    }
+
+    double getUnitTime() {return unitTime;}
+    double getBudget() {return budget;}
+};
+
+#endif